@@ -60,6 +60,7 @@
 #define configCHECK_FOR_STACK_OVERFLOW      1
 
 #define configUSE_TRACE_FACILITY            1
+#define configUSE_APPLICATION_TASK_TAG      1
 #define configUSE_16_BIT_TICKS              1
 
 #define configUSE_MUTEXES                   1
@@ -70,11 +71,12 @@
 #define configUSE_MALLOC_FAILED_HOOK        1
 
 #define configSUPPORT_DYNAMIC_ALLOCATION    1
-#define configSUPPORT_STATIC_ALLOCATION     0
+#define configSUPPORT_STATIC_ALLOCATION     1
 
 /* Timer definitions. */
 #define configUSE_TIMERS                    1
-#define configTIMER_TASK_PRIORITY           ( ( UBaseType_t ) 3 )
+/* Below schedEDF_RUNNING_PRIORITY, see scheduler.cpp. */
+#define configTIMER_TASK_PRIORITY           ( ( UBaseType_t ) 2 )
 #define configTIMER_QUEUE_LENGTH            ( ( UBaseType_t ) 10 )
 #define configTIMER_TASK_STACK_DEPTH        ( 85 )
 
@@ -104,6 +106,33 @@ to exclude the API function. */
 #define INCLUDE_xTaskGetCurrentTaskHandle       1
 #define INCLUDE_uxTaskGetStackHighWaterMark     1
 
+/* Execution time accounting of the periodic task scheduler. The task tag of a
+ * periodic task points to its extended TCB, other tasks have no tag. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vSchedulerTaskSwitchedIn( void *pvTaskTag );
+extern void vSchedulerTaskSwitchedOut( void *pvTaskTag );
+#ifdef __cplusplus
+}
+#endif
+#define traceTASK_SWITCHED_IN()     vSchedulerTaskSwitchedIn( ( void * ) pxCurrentTCB->pxTaskTag )
+#define traceTASK_SWITCHED_OUT()    vSchedulerTaskSwitchedOut( ( void * ) pxCurrentTCB->pxTaskTag )
+
+/* Run time counter of the periodic task scheduler, also used to measure
+ * execution times below the tick resolution. */
+#define configGENERATE_RUN_TIME_STATS       1
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vSchedulerConfigureRunTimeCounter( void );
+extern uint32_t ulSchedulerGetRunTimeCounter( void );
+#ifdef __cplusplus
+}
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vSchedulerConfigureRunTimeCounter()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ulSchedulerGetRunTimeCounter()
+
 #define configMAX(a,b)  ({ __typeof__ (a) _a = (a); __typeof__ (b) _b = (b); _a > _b ? _a : _b; })
 #define configMIN(a,b)  ({ __typeof__ (a) _a = (a); __typeof__ (b) _b = (b); _a < _b ? _a : _b; })
 
@@ -0,0 +1,72 @@
+/* Application hooks of host builds. On the target the Arduino FreeRTOS
+ * library provides them. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Number of ticks after which the idle task prints the run time of every task
+ * and ends the process. The share of the Scheduler task is the scheduler
+ * overhead. 0 runs forever. */
+#ifndef hostRUN_TICKS
+	#define hostRUN_TICKS 0
+#endif /* hostRUN_TICKS */
+
+HostSerial Serial;
+
+extern "C" {
+
+void vApplicationIdleHook(void)
+{
+#if (hostRUN_TICKS > 0)
+	static char cStats[64 * 8];
+
+	if (xTaskGetTickCount() >= (TickType_t)hostRUN_TICKS)
+	{
+		vTaskSuspendAll();
+		vTaskGetRunTimeStats(cStats);
+		printf("\nrun time [us]\n%s", cStats);
+		fflush(stdout);
+		exit(0);
+	}
+#endif /* hostRUN_TICKS */
+}
+
+void vApplicationMallocFailedHook(void)
+{
+	fprintf(stderr, "malloc failed\n");
+	abort();
+}
+
+void vAssertCalled(const char *pcFile, unsigned long ulLine)
+{
+	fprintf(stderr, "assertion failed at %s:%lu\n", pcFile, ulLine);
+	fflush(stdout);
+	abort();
+}
+
+/* Memory of the idle and timer tasks, needed with configSUPPORT_STATIC_ALLOCATION. */
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize)
+{
+	static StaticTask_t xIdleTaskTCB;
+	static StackType_t uxIdleTaskStack[configMINIMAL_STACK_SIZE];
+
+	*ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+	*ppxIdleTaskStackBuffer = uxIdleTaskStack;
+	*pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize)
+{
+	static StaticTask_t xTimerTaskTCB;
+	static StackType_t uxTimerTaskStack[configTIMER_TASK_STACK_DEPTH];
+
+	*ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+	*ppxTimerTaskStackBuffer = uxTimerTaskStack;
+	*pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+
+} /* extern "C" */
@@ -0,0 +1,51 @@
+#ifndef ARDUINO_H_
+#define ARDUINO_H_
+
+/* Stand-in for the Arduino core on host builds. Only the parts used by the
+ * scheduler and the sketch are provided: Serial writes to stdout. */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifndef F_CPU
+	#define F_CPU 16000000UL
+#endif /* F_CPU */
+
+#define DEC 10
+#define HEX 16
+
+#ifdef __cplusplus
+
+class HostSerial
+{
+public:
+	void begin(unsigned long ulBaud) { (void)ulBaud; }
+	void flush(void) { fflush(stdout); }
+	operator bool() const { return true; }
+
+	void print(const char *pcText) { fputs(pcText, stdout); }
+	void print(char cValue) { putchar(cValue); }
+	void print(long lValue, int iBase = DEC) { printf(DEC == iBase ? "%ld" : "%lx", lValue); }
+	void print(unsigned long ulValue, int iBase = DEC) { printf(DEC == iBase ? "%lu" : "%lx", ulValue); }
+	void print(int iValue, int iBase = DEC) { print((long)iValue, iBase); }
+	void print(unsigned int uiValue, int iBase = DEC) { print((unsigned long)uiValue, iBase); }
+	void print(signed char cValue, int iBase = DEC) { print((long)cValue, iBase); }
+	void print(unsigned char ucValue, int iBase = DEC) { print((unsigned long)ucValue, iBase); }
+	void print(double dValue, int iDigits = 2) { printf("%.*f", iDigits, dValue); }
+
+	size_t write(uint8_t ucByte) { return (EOF == putchar(ucByte)) ? 0 : 1; }
+	size_t write(const uint8_t *pucBuffer, size_t xSize) { return fwrite(pucBuffer, 1, xSize, stdout); }
+	/* stdout is buffered, so a write never has to wait. */
+	int availableForWrite(void) { return 64; }
+
+	void println(void) { putchar('\n'); }
+	template <typename T> void println(T xValue) { print(xValue); println(); }
+	template <typename T> void println(T xValue, int iFormat) { print(xValue, iFormat); println(); }
+};
+
+extern HostSerial Serial;
+
+#endif /* __cplusplus */
+
+#endif /* ARDUINO_H_ */
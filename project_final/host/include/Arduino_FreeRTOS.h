@@ -0,0 +1,8 @@
+#ifndef ARDUINO_FREERTOS_H_
+#define ARDUINO_FREERTOS_H_
+
+/* Host builds take the kernel headers from the include path, those of the
+ * mock kernel in mock/ or of a FreeRTOS-Kernel checkout. */
+#include "FreeRTOS.h"
+
+#endif /* ARDUINO_FREERTOS_H_ */
@@ -0,0 +1,103 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Kernel configuration of host builds on the FreeRTOS POSIX port.
+ *
+ * Mirrors project_final/FreeRTOSConfig.h wherever the scheduler depends on
+ * it (priorities, hooks, task tags, trace macros, run time stats, static
+ * allocation). Ticks are 32 bits and stacks are sized for host threads.
+ *
+ * See https://www.freertos.org/a00110.html.
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION                1
+#define configUSE_IDLE_HOOK                 1
+#define configUSE_TICK_HOOK                 1
+#define configTICK_RATE_HZ                  ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                6
+#define configIDLE_SHOULD_YIELD             1
+/* In words, every task runs on a host thread. */
+#define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 4096 )
+#define configMAX_TASK_NAME_LEN             ( 8 )
+
+#define configQUEUE_REGISTRY_SIZE           0
+#define configCHECK_FOR_STACK_OVERFLOW      0
+
+#define configUSE_TRACE_FACILITY            1
+#define configUSE_STATS_FORMATTING_FUNCTIONS    1
+#define configUSE_APPLICATION_TASK_TAG      1
+#define configUSE_16_BIT_TICKS              0
+
+#define configUSE_MUTEXES                   1
+#define configUSE_RECURSIVE_MUTEXES         1
+#define configUSE_COUNTING_SEMAPHORES       1
+#define configUSE_TIME_SLICING              1
+#define configUSE_QUEUE_SETS                0
+#define configUSE_MALLOC_FAILED_HOOK        1
+
+#define configSUPPORT_DYNAMIC_ALLOCATION    1
+#define configSUPPORT_STATIC_ALLOCATION     1
+#define configTOTAL_HEAP_SIZE               ( ( size_t ) ( 1024 * 1024 ) )
+
+/* Timer definitions. */
+#define configUSE_TIMERS                    1
+/* Below schedEDF_RUNNING_PRIORITY, see scheduler.cpp. */
+#define configTIMER_TASK_PRIORITY           ( ( UBaseType_t ) 2 )
+#define configTIMER_QUEUE_LENGTH            ( ( UBaseType_t ) 10 )
+#define configTIMER_TASK_STACK_DEPTH        configMINIMAL_STACK_SIZE
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES               0
+#define configMAX_CO_ROUTINE_PRIORITIES     ( ( UBaseType_t ) 2 )
+
+#define INCLUDE_vTaskPrioritySet                1
+#define INCLUDE_uxTaskPriorityGet               1
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskCleanUpResources           1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_vResumeFromISR                  1
+#define INCLUDE_xTaskDelayUntil                 1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_xTaskGetSchedulerState          1
+#define INCLUDE_xTaskGetIdleTaskHandle          1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1
+#define INCLUDE_uxTaskGetStackHighWaterMark     1
+
+/* Execution time accounting of the periodic task scheduler, as on the target. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vSchedulerTaskSwitchedIn( void *pvTaskTag );
+extern void vSchedulerTaskSwitchedOut( void *pvTaskTag );
+#ifdef __cplusplus
+}
+#endif
+#define traceTASK_SWITCHED_IN()     vSchedulerTaskSwitchedIn( ( void * ) pxCurrentTCB->pxTaskTag )
+#define traceTASK_SWITCHED_OUT()    vSchedulerTaskSwitchedOut( ( void * ) pxCurrentTCB->pxTaskTag )
+
+/* Run time counter of the periodic task scheduler, read from the monotonic
+ * clock on host builds. */
+#define configGENERATE_RUN_TIME_STATS       1
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vSchedulerConfigureRunTimeCounter( void );
+extern uint32_t ulSchedulerGetRunTimeCounter( void );
+#ifdef __cplusplus
+}
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vSchedulerConfigureRunTimeCounter()
+#define portGET_RUN_TIME_COUNTER_VALUE()            ulSchedulerGetRunTimeCounter()
+
+/* Stop at the first failed kernel assertion. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vAssertCalled( const char *pcFile, unsigned long ulLine );
+#ifdef __cplusplus
+}
+#endif
+#define configASSERT( x ) if( ( x ) == 0 ) { vAssertCalled( __FILE__, __LINE__ ); }
+
+#endif /* FREERTOS_CONFIG_H */
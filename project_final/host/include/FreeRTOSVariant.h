@@ -0,0 +1,7 @@
+#ifndef FREERTOS_VARIANT_H_
+#define FREERTOS_VARIANT_H_
+
+/* The AVR variant header selects the watchdog tick source. Host builds tick
+ * from elsewhere and need nothing here. */
+
+#endif /* FREERTOS_VARIANT_H_ */
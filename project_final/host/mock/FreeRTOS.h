@@ -0,0 +1,54 @@
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+/* Mock of the FreeRTOS kernel for host tests of scheduler.cpp that need no
+ * kernel checkout. Tasks never run: a test calls the scheduler functions
+ * itself and sets the tick count with vMockSetTickCount. Types follow the AVR
+ * port of the target, so ticks are 16 bits wide with configUSE_16_BIT_TICKS.
+ * Only the parts of the API used by the scheduler are provided, see
+ * mock_kernel.cpp. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "FreeRTOSConfig.h"
+
+typedef int8_t BaseType_t;
+typedef uint8_t UBaseType_t;
+typedef uint8_t StackType_t;
+
+#if (configUSE_16_BIT_TICKS == 1)
+typedef uint16_t TickType_t;
+#define portMAX_DELAY (TickType_t)0xffff
+#else
+typedef uint32_t TickType_t;
+#define portMAX_DELAY (TickType_t)0xffffffffUL
+#endif /* configUSE_16_BIT_TICKS */
+
+#define pdFALSE ((BaseType_t)0)
+#define pdTRUE ((BaseType_t)1)
+#define pdPASS (pdTRUE)
+#define pdFAIL (pdFALSE)
+
+#define portTICK_PERIOD_MS ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(xTimeInMs) ((TickType_t)(((TickType_t)(xTimeInMs) * (TickType_t)configTICK_RATE_HZ) / (TickType_t)1000))
+
+#define tskIDLE_PRIORITY ((UBaseType_t)0U)
+
+#ifndef configASSERT
+#define configASSERT(x)
+#endif /* configASSERT */
+
+/* Kernel objects only have to be large enough to tell them apart. */
+typedef struct xSTATIC_TCB
+{
+	void *pvDummy[4];
+} StaticTask_t;
+
+typedef struct xSTATIC_QUEUE
+{
+	void *pvDummy[4];
+} StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+
+#endif /* INC_FREERTOS_H */
@@ -0,0 +1,51 @@
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/*-----------------------------------------------------------
+ * Kernel configuration of host tests on the mock kernel.
+ *
+ * Mirrors project_final/FreeRTOSConfig.h wherever the scheduler depends on
+ * it, including the 16 bit ticks of the target, so tests see the tick count
+ * wrap after 65536 ticks.
+ *----------------------------------------------------------*/
+
+#define configUSE_PREEMPTION                1
+#define configUSE_TICK_HOOK                 1
+#define configTICK_RATE_HZ                  ( ( TickType_t ) 1000 )
+#define configMAX_PRIORITIES                6
+#define configMINIMAL_STACK_SIZE            ( ( unsigned short ) 192 )
+#define configMAX_TASK_NAME_LEN             ( 8 )
+#define configUSE_APPLICATION_TASK_TAG      1
+#define configUSE_16_BIT_TICKS              1
+
+#define configSUPPORT_DYNAMIC_ALLOCATION    1
+#define configSUPPORT_STATIC_ALLOCATION     1
+
+#define configUSE_TIMERS                    1
+/* Below schedEDF_RUNNING_PRIORITY, see scheduler.cpp. */
+#define configTIMER_TASK_PRIORITY           ( ( UBaseType_t ) 2 )
+
+/* Run time counter of the periodic task scheduler, read from the monotonic
+ * clock on host builds. */
+#define configGENERATE_RUN_TIME_STATS       1
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vSchedulerConfigureRunTimeCounter( void );
+extern uint32_t ulSchedulerGetRunTimeCounter( void );
+#ifdef __cplusplus
+}
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    vSchedulerConfigureRunTimeCounter()
+
+/* Stop at the first failed assertion. */
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern void vAssertCalled( const char *pcFile, unsigned long ulLine );
+#ifdef __cplusplus
+}
+#endif
+#define configASSERT( x ) if( ( x ) == 0 ) { vAssertCalled( __FILE__, __LINE__ ); }
+
+#endif /* FREERTOS_CONFIG_H */
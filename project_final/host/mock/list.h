@@ -0,0 +1,2 @@
+/* Included by scheduler.h, the mock kernel declares everything in FreeRTOS.h,
+ * task.h and semphr.h. */
@@ -0,0 +1,328 @@
+/* Mock of the FreeRTOS kernel for host tests of scheduler.cpp, see
+ * FreeRTOS.h. Every call returns at once. Tasks only keep what the scheduler
+ * reads back: priority, task tag and whether they are suspended. Semaphores
+ * are binary, mutexes have no holder. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Arduino.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+#define mockMAX_TASKS 128
+#define mockMAX_SEMAPHORES 64
+
+struct tskTaskControlBlock
+{
+	BaseType_t xInUse;
+	UBaseType_t uxPriority;
+	TaskHookFunction_t pxTaskTag;
+	BaseType_t xSuspended;
+};
+
+struct QueueDefinition
+{
+	BaseType_t xInUse;
+	UBaseType_t uxCount;
+	UBaseType_t uxMaxCount;
+};
+
+HostSerial Serial;
+
+static struct tskTaskControlBlock xMockTasks[mockMAX_TASKS];
+static struct QueueDefinition xMockSemaphores[mockMAX_SEMAPHORES];
+static TickType_t xMockTickCount = 0;
+static uint32_t ulMockPrioritySets = 0;
+static TaskHandle_t xMockCurrentTask = NULL;
+static void (*pxMockYieldHook)(TaskHandle_t xTask) = NULL;
+
+static TaskHandle_t prvMockTaskCreate(UBaseType_t uxPriority)
+{
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < mockMAX_TASKS; xIndex++)
+	{
+		if (pdFALSE == xMockTasks[xIndex].xInUse)
+		{
+			xMockTasks[xIndex].xInUse = pdTRUE;
+			xMockTasks[xIndex].uxPriority = uxPriority;
+			xMockTasks[xIndex].pxTaskTag = NULL;
+			xMockTasks[xIndex].xSuspended = pdFALSE;
+			return &xMockTasks[xIndex];
+		}
+	}
+	return NULL;
+}
+
+static SemaphoreHandle_t prvMockSemaphoreCreate(UBaseType_t uxCount)
+{
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < mockMAX_SEMAPHORES; xIndex++)
+	{
+		if (pdFALSE == xMockSemaphores[xIndex].xInUse)
+		{
+			xMockSemaphores[xIndex].xInUse = pdTRUE;
+			xMockSemaphores[xIndex].uxCount = uxCount;
+			xMockSemaphores[xIndex].uxMaxCount = 1;
+			return &xMockSemaphores[xIndex];
+		}
+	}
+	return NULL;
+}
+
+extern "C" {
+
+void vAssertCalled(const char *pcFile, unsigned long ulLine)
+{
+	fprintf(stderr, "assertion failed at %s:%lu\n", pcFile, ulLine);
+	fflush(stdout);
+	abort();
+}
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint16_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask)
+{
+	TaskHandle_t xHandle = prvMockTaskCreate(uxPriority);
+
+	(void)pxTaskCode;
+	(void)pcName;
+	(void)usStackDepth;
+	(void)pvParameters;
+	if (NULL != pxCreatedTask)
+	{
+		*pxCreatedTask = xHandle;
+	}
+	return (NULL != xHandle) ? pdPASS : pdFAIL;
+}
+
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char *pcName, uint32_t ulStackDepth, void *pvParameters, UBaseType_t uxPriority, StackType_t *puxStackBuffer,
+		StaticTask_t *pxTaskBuffer)
+{
+	(void)pxTaskCode;
+	(void)pcName;
+	(void)ulStackDepth;
+	(void)pvParameters;
+	(void)puxStackBuffer;
+	(void)pxTaskBuffer;
+	return prvMockTaskCreate(uxPriority);
+}
+
+void vTaskDelete(TaskHandle_t xTask)
+{
+	if (NULL != xTask)
+	{
+		xTask->xInUse = pdFALSE;
+	}
+}
+
+void vTaskSuspend(TaskHandle_t xTask)
+{
+	if (NULL != xTask)
+	{
+		xTask->xSuspended = pdTRUE;
+	}
+}
+
+void vTaskResume(TaskHandle_t xTask)
+{
+	if (NULL != xTask)
+	{
+		xTask->xSuspended = pdFALSE;
+	}
+}
+
+BaseType_t xTaskResumeFromISR(TaskHandle_t xTask)
+{
+	vTaskResume(xTask);
+	return pdFALSE;
+}
+
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority)
+{
+	UBaseType_t uxOldPriority;
+
+	ulMockPrioritySets++;
+	if (NULL == xTask)
+	{
+		xTask = xMockCurrentTask;
+	}
+	if (NULL != xTask)
+	{
+		uxOldPriority = xTask->uxPriority;
+		xTask->uxPriority = uxNewPriority;
+		if (xTask == xMockCurrentTask && uxNewPriority < uxOldPriority && NULL != pxMockYieldHook)
+		{
+			pxMockYieldHook(xTask);
+		}
+	}
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask)
+{
+	return (NULL != xTask) ? xTask->uxPriority : tskIDLE_PRIORITY;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return xMockCurrentTask;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return xMockTickCount;
+}
+
+TickType_t xTaskGetTickCountFromISR(void)
+{
+	return xMockTickCount;
+}
+
+BaseType_t xTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement)
+{
+	*pxPreviousWakeTime += xTimeIncrement;
+	return pdTRUE;
+}
+
+void vTaskDelay(TickType_t xTicksToDelay)
+{
+	(void)xTicksToDelay;
+}
+
+BaseType_t xTaskAbortDelay(TaskHandle_t xTask)
+{
+	(void)xTask;
+	return pdFAIL;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify)
+{
+	(void)xTaskToNotify;
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	(void)xTaskToNotify;
+	if (NULL != pxHigherPriorityTaskWoken)
+	{
+		*pxHigherPriorityTaskWoken = pdFALSE;
+	}
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait)
+{
+	(void)xClearCountOnExit;
+	(void)xTicksToWait;
+	return 0;
+}
+
+void vTaskStartScheduler(void)
+{
+}
+
+void vTaskSuspendAll(void)
+{
+}
+
+BaseType_t xTaskResumeAll(void)
+{
+	return pdFALSE;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return taskSCHEDULER_NOT_STARTED;
+}
+
+void vTaskSetApplicationTaskTag(TaskHandle_t xTask, TaskHookFunction_t pxHookFunction)
+{
+	xTask->pxTaskTag = pxHookFunction;
+}
+
+TaskHookFunction_t xTaskGetApplicationTaskTag(TaskHandle_t xTask)
+{
+	return (NULL != xTask) ? xTask->pxTaskTag : NULL;
+}
+
+TaskHookFunction_t xTaskGetApplicationTaskTagFromISR(TaskHandle_t xTask)
+{
+	return xTaskGetApplicationTaskTag(xTask);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+	return prvMockSemaphoreCreate(0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *pxSemaphoreBuffer)
+{
+	(void)pxSemaphoreBuffer;
+	return prvMockSemaphoreCreate(0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+	return prvMockSemaphoreCreate(1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t *pxMutexBuffer)
+{
+	(void)pxMutexBuffer;
+	return prvMockSemaphoreCreate(1);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+	(void)xBlockTime;
+	if (0 == xSemaphore->uxCount)
+	{
+		return pdFAIL;
+	}
+	xSemaphore->uxCount--;
+	return pdPASS;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+	if (xSemaphore->uxCount == xSemaphore->uxMaxCount)
+	{
+		return pdFAIL;
+	}
+	xSemaphore->uxCount++;
+	return pdPASS;
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t xSemaphore)
+{
+	return xSemaphore->uxCount;
+}
+
+TaskHandle_t xSemaphoreGetMutexHolder(SemaphoreHandle_t xSemaphore)
+{
+	(void)xSemaphore;
+	return NULL;
+}
+
+void vMockSetTickCount(TickType_t xTickCount)
+{
+	xMockTickCount = xTickCount;
+}
+
+uint32_t ulMockPrioritySetCount(void)
+{
+	return ulMockPrioritySets;
+}
+
+void vMockSetCurrentTask(TaskHandle_t xTask)
+{
+	xMockCurrentTask = xTask;
+}
+
+void vMockSetYieldHook(void (*pxHook)(TaskHandle_t xTask))
+{
+	pxMockYieldHook = pxHook;
+}
+
+} /* extern "C" */
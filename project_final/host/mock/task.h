@@ -0,0 +1,72 @@
+#ifndef INC_TASK_H
+#define INC_TASK_H
+
+/* Task API of the mock kernel, see FreeRTOS.h. */
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+typedef BaseType_t (*TaskHookFunction_t)(void *);
+
+#define taskSCHEDULER_SUSPENDED ((BaseType_t)0)
+#define taskSCHEDULER_NOT_STARTED ((BaseType_t)1)
+#define taskSCHEDULER_RUNNING ((BaseType_t)2)
+
+/* Nothing runs concurrently with a test. */
+#define taskENTER_CRITICAL()
+#define taskEXIT_CRITICAL()
+#define taskENTER_CRITICAL_FROM_ISR() 0
+#define taskEXIT_CRITICAL_FROM_ISR(x) ((void)(x))
+#define taskDISABLE_INTERRUPTS()
+#define taskENABLE_INTERRUPTS()
+#define taskYIELD()
+#define portYIELD_FROM_ISR(x) ((void)(x))
+
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint16_t usStackDepth, void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask);
+TaskHandle_t xTaskCreateStatic(TaskFunction_t pxTaskCode, const char *pcName, uint32_t ulStackDepth, void *pvParameters, UBaseType_t uxPriority, StackType_t *puxStackBuffer,
+		StaticTask_t *pxTaskBuffer);
+void vTaskDelete(TaskHandle_t xTask);
+void vTaskSuspend(TaskHandle_t xTask);
+void vTaskResume(TaskHandle_t xTask);
+BaseType_t xTaskResumeFromISR(TaskHandle_t xTask);
+void vTaskPrioritySet(TaskHandle_t xTask, UBaseType_t uxNewPriority);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t xTask);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+TickType_t xTaskGetTickCount(void);
+TickType_t xTaskGetTickCountFromISR(void);
+BaseType_t xTaskDelayUntil(TickType_t *pxPreviousWakeTime, TickType_t xTimeIncrement);
+void vTaskDelay(TickType_t xTicksToDelay);
+BaseType_t xTaskAbortDelay(TaskHandle_t xTask);
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+void vTaskStartScheduler(void);
+void vTaskSuspendAll(void);
+BaseType_t xTaskResumeAll(void);
+BaseType_t xTaskGetSchedulerState(void);
+void vTaskSetApplicationTaskTag(TaskHandle_t xTask, TaskHookFunction_t pxHookFunction);
+TaskHookFunction_t xTaskGetApplicationTaskTag(TaskHandle_t xTask);
+TaskHookFunction_t xTaskGetApplicationTaskTagFromISR(TaskHandle_t xTask);
+
+/* Test controls of the mock kernel. */
+
+/* Sets the value returned by xTaskGetTickCount. */
+void vMockSetTickCount(TickType_t xTickCount);
+/* Number of vTaskPrioritySet calls so far. */
+uint32_t ulMockPrioritySetCount(void);
+/* Sets the task returned by xTaskGetCurrentTaskHandle, NULL if none. */
+void vMockSetCurrentTask(TaskHandle_t xTask);
+/* pxHook is called whenever the current task lowers its own priority, the
+ * point where a kernel would switch to another task at once. */
+void vMockSetYieldHook(void (*pxHook)(TaskHandle_t xTask));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TASK_H */
@@ -0,0 +1,139 @@
+/* Cost of the EDF dispatcher of scheduler.cpp per scheduling event.
+ *
+ *   make bench
+ *
+ * The scheduler is compiled into this program against the mock kernel, once
+ * per value of schedMAX_NUMBER_OF_PERIODIC_TASKS, see the Makefile. All tasks
+ * are created and have a job ready. One event completes the job with the
+ * earliest deadline and releases its next job, which is what the periodic
+ * tasks do in prvPeriodicJob. For comparison the full selection sort that
+ * prvUpdateEDFPriorities did on every pass before the deadline heap is timed
+ * on the same tasks. Each row shows the time per event and the number of
+ * vTaskPrioritySet calls per event. */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "scheduler.cpp"
+
+#define benchEVENTS 1000000UL
+/* A full sort costs about schedMAX_NUMBER_OF_PERIODIC_TASKS times more. */
+#define benchSORT_PASSES (benchEVENTS / schedMAX_NUMBER_OF_PERIODIC_TASKS)
+
+static char cBenchNames[schedMAX_NUMBER_OF_PERIODIC_TASKS][8];
+static TaskHandle_t xBenchHandles[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+
+static void prvBenchJob(void *pvParameters)
+{
+	(void)pvParameters;
+}
+
+static double prvSeconds(void)
+{
+	struct timespec xNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &xNow);
+	return (double)xNow.tv_sec + (double)xNow.tv_nsec * 1e-9;
+}
+
+/* The EDF priority update before the deadline heap: every pass sorts all
+ * tasks by absolute deadline and sets the priority of each of them. */
+static void prvBenchFullSort(void)
+{
+	BaseType_t xIter, xIndex;
+	TickType_t xShortestTimeLeft;
+	SchedTCB_t *pxShortestTaskPointer = NULL;
+	BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY;
+
+	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	{
+		xTCBArray[xIter].xPriorityIsSet = pdFALSE;
+	}
+
+	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	{
+		xShortestTimeLeft = portMAX_DELAY;
+
+		for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+		{
+			if (xTCBArray[xIndex].xInUse == pdFALSE)
+				continue;
+			if (xTCBArray[xIndex].xPriorityIsSet == pdTRUE)
+				continue;
+
+			if (xShortestTimeLeft > xTCBArray[xIndex].xAbsoluteDeadline)
+			{
+				xShortestTimeLeft = xTCBArray[xIndex].xAbsoluteDeadline;
+				pxShortestTaskPointer = &xTCBArray[xIndex];
+			}
+		}
+
+		if (xHighestPriority > 0)
+		{
+			xHighestPriority--;
+		}
+
+		pxShortestTaskPointer->uxPriority = xHighestPriority;
+		pxShortestTaskPointer->uxBasePriority = pxShortestTaskPointer->uxPriority;
+		pxShortestTaskPointer->xPriorityIsSet = pdTRUE;
+
+		vTaskPrioritySet(*pxShortestTaskPointer->pxTaskHandle, pxShortestTaskPointer->uxPriority);
+	}
+}
+
+int main(void)
+{
+	BaseType_t xIndex;
+	SchedTCB_t *pxTCB;
+	unsigned long ulEvent;
+	uint32_t ulSets;
+	double dStart, dHeap, dSort;
+	double dHeapSets, dSortSets;
+
+	vSchedulerInit();
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		snprintf(cBenchNames[xIndex], sizeof(cBenchNames[xIndex]), "t%d", (int)xIndex);
+		/* Distinct periods keep the deadlines apart, the set is far from full load. */
+		vSchedulerPeriodicTaskCreate(prvBenchJob, cBenchNames[xIndex], configMINIMAL_STACK_SIZE, NULL, 0, &xBenchHandles[xIndex],
+									 0, 20 + 7 * xIndex, 1, 20 + 7 * xIndex, NULL, 0, schedDEADLINE_MISS_CONTINUE, NULL);
+	}
+	prvCreateAllTasks();
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		configASSERT(NULL != xBenchHandles[xIndex]);
+		pxTCB = &xTCBArray[xIndex];
+		pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
+		prvEDFJobReady(pxTCB);
+	}
+
+	ulSets = ulMockPrioritySetCount();
+	dStart = prvSeconds();
+	for (ulEvent = 0; ulEvent < benchEVENTS; ulEvent++)
+	{
+		pxTCB = pxEDFRunningTask;
+		prvEDFJobNotReady(pxTCB, schedEDF_RELEASE_PRIORITY);
+		pxTCB->xLastWakeTime += pxTCB->xPeriod;
+		pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
+		prvEDFJobReady(pxTCB);
+	}
+	dHeap = prvSeconds() - dStart;
+	dHeapSets = (double)(ulMockPrioritySetCount() - ulSets) / benchEVENTS;
+
+	ulSets = ulMockPrioritySetCount();
+	dStart = prvSeconds();
+	for (ulEvent = 0; ulEvent < benchSORT_PASSES; ulEvent++)
+	{
+		pxTCB = &xTCBArray[ulEvent % schedMAX_NUMBER_OF_PERIODIC_TASKS];
+		pxTCB->xAbsoluteDeadline += pxTCB->xPeriod;
+		prvBenchFullSort();
+	}
+	dSort = prvSeconds() - dStart;
+	dSortSets = (double)(ulMockPrioritySetCount() - ulSets) / benchSORT_PASSES;
+
+	printf("%5d %12.1f %10.2f %12.1f %10.2f\n", schedMAX_NUMBER_OF_PERIODIC_TASKS,
+		   dHeap * 1e9 / benchEVENTS, dHeapSets, dSort * 1e9 / benchSORT_PASSES, dSortSets);
+
+	return 0;
+}
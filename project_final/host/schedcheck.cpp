@@ -0,0 +1,417 @@
+/* Checks of the analysis module against brute force on random task sets.
+ *
+ *   make check
+ *   ./build/schedcheck [-s sets] [-x seed]
+ *
+ * The sets are small, periods divide 120, so that the brute force stays
+ * cheap:
+ *
+ * - ulSchedAnalysisEDF (QPA) against the processor demand at every absolute
+ *   deadline up to the hyperperiod plus the longest deadline, with the largest
+ *   blocking term added at every point as the test does.
+ * - xSchedAnalysisAudsley against every priority order of the set, each
+ *   checked by xSchedAnalysisFixedPriority.
+ * - The discrete-event simulator against the analysis. With the Audsley
+ *   order, no simulated job may take longer than its response time bound
+ *   under OPCP or IPCP, and without resources the longest simulated response
+ *   time after a synchronous release must equal the bound. A set that passes
+ *   QPA must not miss a deadline in the EDF simulation, from a synchronous
+ *   release and from random phases. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "schedsim.h"
+#include "../schedanalysis.h"
+
+#define checkMAX_TASKS 6
+#define checkRESOURCES 2
+#define checkHYPERPERIOD 120UL
+
+typedef struct xCheckSet
+{
+	SchedAnalysisTask_t xTasks[checkMAX_TASKS];
+	size_t xTaskCount;
+} CheckSet_t;
+
+static unsigned long ulFailures = 0;
+
+/* xorshift64*, as in schedexp.cpp. The sets are drawn from ullSetState, so
+ * they do not change with the checks. */
+static uint64_t ullSetState = 1;
+
+static uint32_t prvRandom(uint64_t *pullState, uint32_t ulRange)
+{
+	uint64_t ullX = *pullState;
+
+	ullX ^= ullX >> 12;
+	ullX ^= ullX << 25;
+	ullX ^= ullX >> 27;
+	*pullState = ullX;
+
+	return (uint32_t)(((ullX * 0x2545F4914F6CDD1DULL) >> 32) % ulRange);
+}
+
+/* Task sets of 2 to checkMAX_TASKS tasks with a utilization around 1, with
+ * constrained deadlines and short critical sections on checkRESOURCES
+ * resources. */
+static void prvGenerateSet(CheckSet_t *pxSet)
+{
+	static const uint32_t ulPeriods[] = { 4, 5, 6, 8, 10, 12, 15, 20, 24, 30, 40, 60, 120 };
+	size_t xIndex, xResource;
+
+	memset(pxSet, 0, sizeof(*pxSet));
+	pxSet->xTaskCount = 2 + prvRandom(&ullSetState, checkMAX_TASKS - 1);
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		SchedAnalysisTask_t *pxTask = &pxSet->xTasks[xIndex];
+		uint32_t ulCritical = 0;
+
+		pxTask->ulPeriod = ulPeriods[prvRandom(&ullSetState, sizeof(ulPeriods) / sizeof(ulPeriods[0]))];
+		/* Up to 3 / 2n of the period, a mean utilization of about 3 / 4. */
+		pxTask->ulExecTime = 1 + prvRandom(&ullSetState, 3 * pxTask->ulPeriod / (uint32_t)pxSet->xTaskCount / 2);
+		if (pxTask->ulExecTime > pxTask->ulPeriod)
+		{
+			pxTask->ulExecTime = pxTask->ulPeriod;
+		}
+		pxTask->ulDeadline = pxTask->ulExecTime + prvRandom(&ullSetState, pxTask->ulPeriod - pxTask->ulExecTime + 1);
+		for (xResource = 0; xResource < checkRESOURCES; xResource++)
+		{
+			if (0 == prvRandom(&ullSetState, 3))
+			{
+				uint32_t ulLength = 1 + prvRandom(&ullSetState, 1 + pxTask->ulExecTime / 3);
+
+				if (ulCritical + ulLength <= pxTask->ulExecTime)
+				{
+					xSchedAnalysisAddResource(pxTask, xResource, ulLength);
+					ulCritical += ulLength;
+				}
+			}
+		}
+	}
+}
+
+static void prvFail(unsigned long ulSet, const char *pcWhat, const CheckSet_t *pxSet)
+{
+	size_t xIndex, xUse;
+
+	if (ulFailures++ >= 20)
+	{
+		return;
+	}
+	fprintf(stderr, "set %lu: %s\n", ulSet, pcWhat);
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		const SchedAnalysisTask_t *pxTask = &pxSet->xTasks[xIndex];
+
+		fprintf(stderr, "  T %lu D %lu C %lu", (unsigned long)pxTask->ulPeriod, (unsigned long)pxTask->ulDeadline, (unsigned long)pxTask->ulExecTime);
+		for (xUse = 0; xUse < pxTask->xResourceUseCount; xUse++)
+		{
+			fprintf(stderr, " r%u:%lu", pxTask->xResourceUse[xUse].usResource, (unsigned long)pxTask->xResourceUse[xUse].ulCriticalSection);
+		}
+		fprintf(stderr, "\n");
+	}
+}
+
+/* Demand of the jobs with release and deadline in [0, ulTime], synchronous
+ * release, plus ulBlocking. */
+static uint32_t prvDemand(const CheckSet_t *pxSet, uint32_t ulTime, uint32_t ulBlocking)
+{
+	uint32_t ulDemand = ulBlocking;
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		const SchedAnalysisTask_t *pxTask = &pxSet->xTasks[xIndex];
+
+		if (ulTime >= pxTask->ulDeadline)
+		{
+			ulDemand += ((ulTime - pxTask->ulDeadline) / pxTask->ulPeriod + 1) * pxTask->ulExecTime;
+		}
+	}
+
+	return ulDemand;
+}
+
+/* QPA against the demand at every absolute deadline. Under a utilization above
+ * 1 the demand exceeds the interval somewhere, so that case needs no scan. */
+static void prvCheckEDF(unsigned long ulSet, CheckSet_t *pxSet)
+{
+	uint32_t ulBlocking = 0, ulUtilization = 0, ulFailedAt, ulTime, ulEnd = checkHYPERPERIOD;
+	int iSchedulable = 1;
+	size_t xIndex;
+
+	ulFailedAt = ulSchedAnalysisEDF(pxSet->xTasks, pxSet->xTaskCount, checkRESOURCES, NULL);
+
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		const SchedAnalysisTask_t *pxTask = &pxSet->xTasks[xIndex];
+
+		if (pxTask->ulBlocking > ulBlocking)
+		{
+			ulBlocking = pxTask->ulBlocking;
+		}
+		ulUtilization += pxTask->ulExecTime * (checkHYPERPERIOD / pxTask->ulPeriod);
+		if (checkHYPERPERIOD + pxTask->ulDeadline > ulEnd)
+		{
+			ulEnd = checkHYPERPERIOD + pxTask->ulDeadline;
+		}
+	}
+	if (ulUtilization > checkHYPERPERIOD)
+	{
+		iSchedulable = 0;
+	}
+	for (xIndex = 0; xIndex < pxSet->xTaskCount && 1 == iSchedulable; xIndex++)
+	{
+		for (ulTime = pxSet->xTasks[xIndex].ulDeadline; ulTime <= ulEnd; ulTime += pxSet->xTasks[xIndex].ulPeriod)
+		{
+			if (prvDemand(pxSet, ulTime, ulBlocking) > ulTime)
+			{
+				iSchedulable = 0;
+			}
+		}
+	}
+
+	if (iSchedulable != (0 == ulFailedAt))
+	{
+		prvFail(ulSet, iSchedulable ? "QPA rejects a set the demand scan accepts" : "QPA accepts a set the demand scan rejects", pxSet);
+	}
+	else if (schedANALYSIS_MAX_BUSY_PERIOD == ulFailedAt)
+	{
+		/* The busy period of these sets is bounded below a utilization of 1. */
+		if (ulUtilization < checkHYPERPERIOD)
+		{
+			prvFail(ulSet, "QPA finds no end of the busy period", pxSet);
+		}
+	}
+	else if (0 != ulFailedAt && prvDemand(pxSet, ulFailedAt, ulBlocking) <= ulFailedAt)
+	{
+		prvFail(ulSet, "QPA reports an interval whose demand fits", pxSet);
+	}
+}
+
+/* Steps pulOrder to the next permutation in lexicographic order. Returns 0
+ * after the last one. */
+static int prvNextOrder(uint32_t *pulOrder, size_t xCount)
+{
+	size_t xPivot = xCount - 1, xSwap = xCount - 1;
+	uint32_t ulSwap;
+
+	while (xPivot > 0 && pulOrder[xPivot - 1] >= pulOrder[xPivot])
+	{
+		xPivot--;
+	}
+	if (0 == xPivot)
+	{
+		return 0;
+	}
+	while (pulOrder[xSwap] <= pulOrder[xPivot - 1])
+	{
+		xSwap--;
+	}
+	ulSwap = pulOrder[xPivot - 1];
+	pulOrder[xPivot - 1] = pulOrder[xSwap];
+	pulOrder[xSwap] = ulSwap;
+	for (xSwap = xCount - 1; xPivot < xSwap; xPivot++, xSwap--)
+	{
+		ulSwap = pulOrder[xPivot];
+		pulOrder[xPivot] = pulOrder[xSwap];
+		pulOrder[xSwap] = ulSwap;
+	}
+
+	return 1;
+}
+
+/* Audsley finds an order exactly when one of the n! orders passes the response
+ * time test, and the order it finds passes it. Returns 1 if it found one. */
+static int prvCheckAudsley(unsigned long ulSet, CheckSet_t *pxSet)
+{
+	CheckSet_t xOrdered = *pxSet;
+	uint32_t ulOrder[checkMAX_TASKS];
+	size_t xIndex, xUnplaced;
+	int iFeasible = 0;
+
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		ulOrder[xIndex] = (uint32_t)xIndex + 1;
+	}
+	do
+	{
+		for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+		{
+			xOrdered.xTasks[xIndex].ulPriority = ulOrder[xIndex];
+		}
+		iFeasible = (0 == xSchedAnalysisFixedPriority(xOrdered.xTasks, xOrdered.xTaskCount, checkRESOURCES)) ? 1 : 0;
+	} while (0 == iFeasible && prvNextOrder(ulOrder, pxSet->xTaskCount));
+
+	xUnplaced = xSchedAnalysisAudsley(pxSet->xTasks, pxSet->xTaskCount, checkRESOURCES);
+	if (iFeasible != (0 == xUnplaced))
+	{
+		prvFail(ulSet, iFeasible ? "Audsley misses a feasible priority order" : "Audsley places a set without a feasible order", pxSet);
+	}
+	else if (0 == xUnplaced && 0 != xSchedAnalysisFixedPriority(pxSet->xTasks, pxSet->xTaskCount, checkRESOURCES))
+	{
+		prvFail(ulSet, "the order found by Audsley fails the response time test", pxSet);
+	}
+
+	return iFeasible;
+}
+
+/* Simulates the set with worst-case execution times for two hyperperiods
+ * after the last first release. Returns the number of deadline misses. */
+static uint32_t prvSimulate(const CheckSet_t *pxSet, uint8_t ucPolicy, uint8_t ucProtocol, const uint32_t *pulPhase, SchedSimTask_t *pxTasks)
+{
+	SchedSim_t xSim;
+	uint32_t ulLastPhase = 0;
+	size_t xIndex, xUse;
+
+	memset(pxTasks, 0, pxSet->xTaskCount * sizeof(SchedSimTask_t));
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		const SchedAnalysisTask_t *pxTask = &pxSet->xTasks[xIndex];
+
+		pxTasks[xIndex].ulPhase = pulPhase[xIndex];
+		pxTasks[xIndex].ulPeriod = pxTask->ulPeriod;
+		pxTasks[xIndex].ulDeadline = pxTask->ulDeadline;
+		pxTasks[xIndex].ulExecTime = pxTask->ulExecTime;
+		pxTasks[xIndex].ulExecTimeMin = pxTask->ulExecTime;
+		pxTasks[xIndex].ulExecTimeMax = pxTask->ulExecTime;
+		pxTasks[xIndex].ulPriority = pxTask->ulPriority;
+		pxTasks[xIndex].ucMissPolicy = schedSIM_MISS_CONTINUE;
+		for (xUse = 0; xUse < pxTask->xResourceUseCount; xUse++)
+		{
+			pxTasks[xIndex].ulCriticalSection[pxTask->xResourceUse[xUse].usResource] = pxTask->xResourceUse[xUse].ulCriticalSection;
+		}
+		if (pulPhase[xIndex] > ulLastPhase)
+		{
+			ulLastPhase = pulPhase[xIndex];
+		}
+	}
+
+	memset(&xSim, 0, sizeof(xSim));
+	xSim.pxTasks = pxTasks;
+	xSim.xTaskCount = pxSet->xTaskCount;
+	xSim.xResourceCount = checkRESOURCES;
+	xSim.ucPolicy = ucPolicy;
+	xSim.ucProtocol = ucProtocol;
+	xSim.ulSeed = 1;
+	vSchedSimInit(&xSim);
+
+	return ulSchedSimRun(&xSim, ulLastPhase + 2 * checkHYPERPERIOD);
+}
+
+/* pxSet holds the Audsley order and the results of the analysis. */
+static void prvCheckSimFixedPriority(unsigned long ulSet, const CheckSet_t *pxSet)
+{
+	static const uint8_t ucProtocols[] = { schedSIM_PROTOCOL_OPCP, schedSIM_PROTOCOL_IPCP };
+	SchedSimTask_t xTasks[checkMAX_TASKS];
+	uint32_t ulPhase[checkMAX_TASKS] = { 0 };
+	size_t xIndex, xProtocol;
+	int iResources = 0;
+
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		iResources |= (0 != pxSet->xTasks[xIndex].xResourceUseCount) ? 1 : 0;
+	}
+
+	for (xProtocol = 0; xProtocol < sizeof(ucProtocols); xProtocol++)
+	{
+		if (0 != prvSimulate(pxSet, schedSIM_POLICY_FIXED, ucProtocols[xProtocol], ulPhase, xTasks))
+		{
+			prvFail(ulSet, "a set that passes the response time test misses a deadline in the simulation", pxSet);
+			return;
+		}
+		for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+		{
+			if (xTasks[xIndex].ulMaxResponseTime > pxSet->xTasks[xIndex].ulResponseTime)
+			{
+				prvFail(ulSet, "a simulated response time exceeds the analysis", pxSet);
+				return;
+			}
+			if (0 == iResources && xTasks[xIndex].ulMaxResponseTime != pxSet->xTasks[xIndex].ulResponseTime)
+			{
+				prvFail(ulSet, "the simulated response time differs from the analysis without resources", pxSet);
+				return;
+			}
+		}
+	}
+}
+
+static void prvCheckSimEDF(unsigned long ulSet, const CheckSet_t *pxSet)
+{
+	static const uint8_t ucProtocols[] = { schedSIM_PROTOCOL_OPCP, schedSIM_PROTOCOL_IPCP, schedSIM_PROTOCOL_SRP };
+	SchedSimTask_t xTasks[checkMAX_TASKS];
+	uint32_t ulPhase[checkMAX_TASKS] = { 0 };
+	uint64_t ullPhaseState = ulSet + 1;
+	size_t xIndex, xProtocol;
+
+	for (xProtocol = 0; xProtocol < sizeof(ucProtocols); xProtocol++)
+	{
+		if (0 != prvSimulate(pxSet, schedSIM_POLICY_EDF, ucProtocols[xProtocol], ulPhase, xTasks))
+		{
+			prvFail(ulSet, "a set that passes QPA misses a deadline in the simulation", pxSet);
+			return;
+		}
+	}
+
+	for (xIndex = 0; xIndex < pxSet->xTaskCount; xIndex++)
+	{
+		ulPhase[xIndex] = prvRandom(&ullPhaseState, pxSet->xTasks[xIndex].ulPeriod);
+	}
+	for (xProtocol = 0; xProtocol < sizeof(ucProtocols); xProtocol++)
+	{
+		if (0 != prvSimulate(pxSet, schedSIM_POLICY_EDF, ucProtocols[xProtocol], ulPhase, xTasks))
+		{
+			prvFail(ulSet, "a set that passes QPA misses a deadline in the simulation with phases", pxSet);
+			return;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	unsigned long ulSets = 20000, ulSet, ulSchedulable = 0, ulFeasible = 0;
+	CheckSet_t xSet, xCopy;
+	int iOption;
+
+	while (-1 != (iOption = getopt(argc, argv, "s:x:")))
+	{
+		switch (iOption)
+		{
+			case 's': ulSets = strtoul(optarg, NULL, 0); break;
+			case 'x': ullSetState = strtoull(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "usage: %s [-s sets] [-x seed]\n", argv[0]);
+				return 2;
+		}
+	}
+	if (0 == ullSetState)
+	{
+		ullSetState = 1;
+	}
+
+	for (ulSet = 0; ulSet < ulSets; ulSet++)
+	{
+		prvGenerateSet(&xSet);
+		xCopy = xSet;
+		prvCheckEDF(ulSet, &xCopy);
+		if (schedANALYSIS_UNSCHEDULABLE != xCopy.xTasks[0].ulResponseTime)
+		{
+			ulSchedulable++;
+			prvCheckSimEDF(ulSet, &xCopy);
+		}
+		xCopy = xSet;
+		if (prvCheckAudsley(ulSet, &xCopy))
+		{
+			ulFeasible++;
+			prvCheckSimFixedPriority(ulSet, &xCopy);
+		}
+	}
+
+	printf("%lu sets, %lu EDF schedulable, %lu with a feasible fixed priority order\n", ulSets, ulSchedulable, ulFeasible);
+	printf("%lu failures\n", ulFailures);
+
+	return (0 == ulFailures) ? 0 : 1;
+}
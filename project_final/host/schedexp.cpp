@@ -0,0 +1,593 @@
+/* Schedulability ratio experiments over random task sets.
+ *
+ *   schedexp [options] > ratios.csv
+ *
+ *   -n tasks       tasks per set (5)
+ *   -r resources   shared resources (2)
+ *   -u from:to:step  total utilization points (0.05:1:0.05)
+ *   -s sets        task sets per utilization point (1000)
+ *   -g uunifast|randfixedsum  utilization generator (uunifast)
+ *   -p uniform|loguniform|harmonic  period distribution (loguniform)
+ *   -P min:max     period range in ticks (10:1000)
+ *   -d min:max     deadline ratio, D = C + ratio * (T - C) (1:1)
+ *   -c probability that a task uses a resource (0.3)
+ *   -l longest critical section as fraction of the execution time (0.2)
+ *   -e shortest execution time as fraction of the worst case (1)
+ *   -T simulated time in ticks (10 times the longest period)
+ *   -x seed (1)
+ *   -j worker threads (all cores)
+ *   -t check the utilization generators and exit
+ *
+ * Every set is checked by the analysis and simulated under RMS, DM, OPA and
+ * EDF, each with OPCP and IPCP. Jobs missing their deadline are aborted. One
+ * CSV row is written per utilization point and configuration with the share
+ * of sets found schedulable by the analysis, the share of sets that missed no
+ * deadline in the simulation and the share of missed jobs. The sets only
+ * depend on the seed, not on the number of threads. */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "schedsim.h"
+#include "../schedanalysis.h"
+
+#define expMAX_TASKS 64
+#define expMAX_POINTS 1024
+
+#define expGEN_UUNIFAST		0
+#define expGEN_RANDFIXEDSUM	1
+
+#define expPERIOD_UNIFORM		0
+#define expPERIOD_LOGUNIFORM	1
+#define expPERIOD_HARMONIC		2
+
+#define expPOLICY_COUNT 4
+#define expPROTOCOL_COUNT 2
+#define expCONFIG_COUNT (expPOLICY_COUNT * expPROTOCOL_COUNT)
+
+typedef struct xExperiment
+{
+	size_t xTaskCount;
+	size_t xResourceCount;
+	double dUtilFrom, dUtilTo, dUtilStep;
+	size_t xPointCount;
+	uint32_t ulSetsPerPoint;
+	int iGenerator;
+	int iPeriodDistribution;
+	uint32_t ulPeriodMin, ulPeriodMax;
+	double dDeadlineMin, dDeadlineMax;
+	double dResourceProbability;
+	double dCriticalSectionMax;
+	double dExecTimeMin;
+	uint64_t ullSimTime;
+	uint64_t ullSeed;
+	unsigned uThreads;
+
+	/* Next work item, one task set, taken by the workers. */
+	uint32_t ulNextItem;
+} Experiment_t;
+
+/* Per utilization point and configuration. */
+typedef struct xResult
+{
+	uint32_t ulAnalysisSchedulable;
+	uint32_t ulSimulationSchedulable;
+	uint64_t ullMisses;
+	uint64_t ullJobs;
+} Result_t;
+
+static Experiment_t xExp;
+static Result_t xResults[expMAX_POINTS][expCONFIG_COUNT];
+
+static const char *const pcPolicyNames[expPOLICY_COUNT] = { "RMS", "DM", "OPA", "EDF" };
+static const char *const pcProtocolNames[expPROTOCOL_COUNT] = { "OPCP", "IPCP" };
+
+/* xorshift64*, one state per task set. */
+static double prvRandom(uint64_t *pullState)
+{
+	uint64_t ullX = *pullState;
+
+	ullX ^= ullX >> 12;
+	ullX ^= ullX << 25;
+	ullX ^= ullX >> 27;
+	*pullState = ullX;
+
+	return (double)((ullX * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* UUniFast (Bini and Buttazzo): n utilizations summing to dTotal. */
+static void prvUUniFast(uint64_t *pullState, size_t xCount, double dTotal, double *pdUtil)
+{
+	double dSum = dTotal;
+	size_t xIndex;
+
+	for (xIndex = 1; xIndex < xCount; xIndex++)
+	{
+		double dNext = dSum * pow(prvRandom(pullState), 1.0 / (double)(xCount - xIndex));
+
+		pdUtil[xIndex - 1] = dSum - dNext;
+		dSum = dNext;
+	}
+	pdUtil[xCount - 1] = dSum;
+}
+
+/* Randfixedsum (Stafford, as used by Emberson, Stafford and Davis): n values
+ * in [0, 1] summing to dTotal, uniformly distributed over that set. Unlike
+ * UUniFast it stays uniform above a total of 1. */
+static void prvRandFixedSum(uint64_t *pullState, size_t xCount, double dTotal, double *pdUtil)
+{
+	static const double dTiny = 4.9406564584124654e-324;
+	double dW[expMAX_TASKS + 1][expMAX_TASKS + 2];
+	double dT[expMAX_TASKS][expMAX_TASKS + 1];
+	double dS1[expMAX_TASKS + 1], dS2[expMAX_TASKS + 1];
+	double dS = dTotal, dSum = 0.0, dProduct = 1.0;
+	size_t n = xCount, i, c, k;
+	long lJ;
+
+	/* 1 based indices as in the reference implementation. */
+	k = (dS < 0.0) ? 0 : (size_t)floor(dS);
+	if (k > n - 1)
+	{
+		k = n - 1;
+	}
+	if (dS < (double)k)
+	{
+		dS = (double)k;
+	}
+	if (dS > (double)k + 1.0)
+	{
+		dS = (double)k + 1.0;
+	}
+	for (i = 1; i <= n; i++)
+	{
+		dS1[i] = dS - ((double)k - (double)(i - 1));
+		dS2[i] = ((double)(k + n) - (double)(i - 1)) - dS;
+	}
+
+	memset(dW, 0, sizeof(dW));
+	memset(dT, 0, sizeof(dT));
+	dW[1][2] = 1.7976931348623157e308;
+	for (i = 2; i <= n; i++)
+	{
+		for (c = 1; c <= i; c++)
+		{
+			double dTmp1 = dW[i - 1][c + 1] * dS1[c] / (double)i;
+			double dTmp2 = dW[i - 1][c] * dS2[n - i + c] / (double)i;
+			double dTmp3;
+
+			dW[i][c + 1] = dTmp1 + dTmp2;
+			dTmp3 = dW[i][c + 1] + dTiny;
+			dT[i - 1][c] = (dS2[n - i + c] > dS1[c]) ? dTmp2 / dTmp3 : 1.0 - dTmp1 / dTmp3;
+		}
+	}
+
+	lJ = (long)k + 1;
+	for (i = n - 1; i >= 1; i--)
+	{
+		int iE = (prvRandom(pullState) <= dT[i][lJ]) ? 1 : 0;
+		double dSx = pow(prvRandom(pullState), 1.0 / (double)i);
+
+		dSum += (1.0 - dSx) * dProduct * dS / (double)(i + 1);
+		dProduct *= dSx;
+		pdUtil[n - i - 1] = dSum + dProduct * iE;
+		dS -= iE;
+		lJ -= iE;
+	}
+	pdUtil[n - 1] = dSum + dProduct * dS;
+
+	/* Random order. */
+	for (i = n - 1; i > 0; i--)
+	{
+		size_t xOther = (size_t)(prvRandom(pullState) * (double)(i + 1));
+		double dSwap = pdUtil[i];
+
+		pdUtil[i] = pdUtil[xOther];
+		pdUtil[xOther] = dSwap;
+	}
+}
+
+/* Draws expCHECK_DRAWS sets from both generators for several task counts and
+ * totals. Every value must lie in [0, 1], or [0, total] for UUniFast below a
+ * total of 1, and every set must sum to the total. Under Randfixedsum the mean
+ * of every position must be total / n. Returns the number of failed checks. */
+#define expCHECK_DRAWS 20000
+
+static unsigned prvCheckGenerators(void)
+{
+	static const size_t xCounts[] = { 2, 5, 8, 16 };
+	double dUtil[expMAX_TASKS], dMean[expMAX_TASKS], dTotal, dSum;
+	uint64_t ullState = 1;
+	unsigned uFailures = 0;
+	size_t xCount, xIndex, xStep;
+	uint32_t ulDraw;
+	int iGenerator;
+
+	for (xCount = 0; xCount < sizeof(xCounts) / sizeof(xCounts[0]); xCount++)
+	{
+		size_t n = xCounts[xCount];
+
+		for (xStep = 1; xStep < 2 * n; xStep++)
+		{
+			dTotal = 0.5 * (double)xStep;
+			for (iGenerator = expGEN_UUNIFAST; iGenerator <= expGEN_RANDFIXEDSUM; iGenerator++)
+			{
+				int iRangeFailed = 0, iSumFailed = 0;
+
+				/* UUniFast stays in [0, 1] only up to a total of 1. */
+				if (expGEN_UUNIFAST == iGenerator && dTotal > 1.0)
+				{
+					continue;
+				}
+				memset(dMean, 0, sizeof(dMean));
+				for (ulDraw = 0; ulDraw < expCHECK_DRAWS; ulDraw++)
+				{
+					if (expGEN_RANDFIXEDSUM == iGenerator)
+					{
+						prvRandFixedSum(&ullState, n, dTotal, dUtil);
+					}
+					else
+					{
+						prvUUniFast(&ullState, n, dTotal, dUtil);
+					}
+					dSum = 0.0;
+					for (xIndex = 0; xIndex < n; xIndex++)
+					{
+						iRangeFailed |= (dUtil[xIndex] < -1e-9 || dUtil[xIndex] > 1.0 + 1e-9) ? 1 : 0;
+						dSum += dUtil[xIndex];
+						dMean[xIndex] += dUtil[xIndex] / expCHECK_DRAWS;
+					}
+					iSumFailed |= (fabs(dSum - dTotal) > 1e-9) ? 1 : 0;
+				}
+				if (iRangeFailed || iSumFailed)
+				{
+					fprintf(stderr, "%s n %u total %.1f: value %s\n", (expGEN_RANDFIXEDSUM == iGenerator) ? "randfixedsum" : "uunifast",
+							(unsigned)n, dTotal, iRangeFailed ? "outside [0, 1]" : "sum differs from the total");
+					uFailures++;
+				}
+				for (xIndex = 0; xIndex < n && expGEN_RANDFIXEDSUM == iGenerator; xIndex++)
+				{
+					if (fabs(dMean[xIndex] - dTotal / (double)n) > 0.02)
+					{
+						fprintf(stderr, "randfixedsum n %u total %.1f: mean %f of position %u\n", (unsigned)n, dTotal, dMean[xIndex], (unsigned)xIndex);
+						uFailures++;
+					}
+				}
+			}
+		}
+	}
+
+	return uFailures;
+}
+
+static uint32_t prvPeriod(uint64_t *pullState)
+{
+	double dMin = (double)xExp.ulPeriodMin, dMax = (double)xExp.ulPeriodMax;
+
+	if (expPERIOD_UNIFORM == xExp.iPeriodDistribution)
+	{
+		return (uint32_t)(dMin + prvRandom(pullState) * (dMax - dMin + 1.0));
+	}
+	if (expPERIOD_HARMONIC == xExp.iPeriodDistribution)
+	{
+		uint32_t ulSteps = 0, ulPeriod;
+
+		while (((uint64_t)xExp.ulPeriodMin << (ulSteps + 1)) <= xExp.ulPeriodMax)
+		{
+			ulSteps++;
+		}
+		ulPeriod = xExp.ulPeriodMin << (uint32_t)(prvRandom(pullState) * (double)(ulSteps + 1));
+		return ulPeriod;
+	}
+
+	return (uint32_t)exp(log(dMin) + prvRandom(pullState) * (log(dMax + 1.0) - log(dMin)));
+}
+
+/* Generates task set xSet of utilization point xPoint. */
+static void prvGenerateTaskSet(size_t xPoint, uint32_t ulSet, SchedSimTask_t *pxTasks)
+{
+	double dUtil[expMAX_TASKS];
+	double dTotal = xExp.dUtilFrom + (double)xPoint * xExp.dUtilStep;
+	uint64_t ullState = (xExp.ullSeed * 0x9E3779B97F4A7C15ULL) ^ (((uint64_t)xPoint << 32) | ulSet) ^ 0xD1B54A32D192ED03ULL;
+	size_t xIndex, xResource;
+
+	if (0 == ullState)
+	{
+		ullState = 1;
+	}
+
+	if (expGEN_RANDFIXEDSUM == xExp.iGenerator)
+	{
+		prvRandFixedSum(&ullState, xExp.xTaskCount, dTotal, dUtil);
+	}
+	else
+	{
+		prvUUniFast(&ullState, xExp.xTaskCount, dTotal, dUtil);
+	}
+
+	memset(pxTasks, 0, xExp.xTaskCount * sizeof(SchedSimTask_t));
+	for (xIndex = 0; xIndex < xExp.xTaskCount; xIndex++)
+	{
+		SchedSimTask_t *pxTask = &pxTasks[xIndex];
+		uint32_t ulCritical = 0;
+		double dRatio = xExp.dDeadlineMin + prvRandom(&ullState) * (xExp.dDeadlineMax - xExp.dDeadlineMin);
+
+		pxTask->ulPeriod = prvPeriod(&ullState);
+		pxTask->ulExecTime = (uint32_t)(dUtil[xIndex] * (double)pxTask->ulPeriod + 0.5);
+		if (0 == pxTask->ulExecTime)
+		{
+			pxTask->ulExecTime = 1;
+		}
+		if (pxTask->ulExecTime > pxTask->ulPeriod)
+		{
+			pxTask->ulExecTime = pxTask->ulPeriod;
+		}
+		pxTask->ulDeadline = pxTask->ulExecTime + (uint32_t)(dRatio * (double)(pxTask->ulPeriod - pxTask->ulExecTime) + 0.5);
+		pxTask->ulExecTimeMax = pxTask->ulExecTime;
+		pxTask->ulExecTimeMin = (uint32_t)(xExp.dExecTimeMin * (double)pxTask->ulExecTime);
+		pxTask->ucMissPolicy = schedSIM_MISS_ABORT;
+
+		/* Critical sections fit into the execution time. */
+		for (xResource = 0; xResource < xExp.xResourceCount; xResource++)
+		{
+			if (prvRandom(&ullState) < xExp.dResourceProbability)
+			{
+				uint32_t ulLongest = (uint32_t)(xExp.dCriticalSectionMax * (double)pxTask->ulExecTime);
+				uint32_t ulLength = 1 + (uint32_t)(prvRandom(&ullState) * (double)(ulLongest > 1 ? ulLongest : 1));
+
+				if (ulCritical + ulLength <= pxTask->ulExecTime)
+				{
+					pxTask->ulCriticalSection[xResource] = ulLength;
+					ulCritical += ulLength;
+				}
+			}
+		}
+		if (pxTask->ulExecTimeMin < ulCritical)
+		{
+			pxTask->ulExecTimeMin = ulCritical;
+		}
+	}
+}
+
+/* Runs the analysis of one configuration. Returns 1 if the set is schedulable
+ * and sets the priorities of the simulated tasks. */
+static int prvAnalyse(SchedSimTask_t *pxTasks, int iPolicy)
+{
+	SchedAnalysisTask_t xTasks[expMAX_TASKS];
+	size_t xIndex, xResource;
+	int iSchedulable;
+
+	memset(xTasks, 0, xExp.xTaskCount * sizeof(SchedAnalysisTask_t));
+	for (xIndex = 0; xIndex < xExp.xTaskCount; xIndex++)
+	{
+		xTasks[xIndex].ulPeriod = pxTasks[xIndex].ulPeriod;
+		xTasks[xIndex].ulDeadline = pxTasks[xIndex].ulDeadline;
+		xTasks[xIndex].ulExecTime = pxTasks[xIndex].ulExecTime;
+		for (xResource = 0; xResource < xExp.xResourceCount; xResource++)
+		{
+			xSchedAnalysisAddResource(&xTasks[xIndex], xResource, pxTasks[xIndex].ulCriticalSection[xResource]);
+		}
+	}
+
+	if (schedSIM_POLICY_EDF == iPolicy)
+	{
+		return 0 == ulSchedAnalysisEDF(xTasks, xExp.xTaskCount, xExp.xResourceCount, NULL);
+	}
+
+	if (schedSIM_POLICY_FIXED == iPolicy)
+	{
+		iSchedulable = 0 == xSchedAnalysisAudsley(xTasks, xExp.xTaskCount, xExp.xResourceCount);
+		for (xIndex = 0; xIndex < xExp.xTaskCount; xIndex++)
+		{
+			pxTasks[xIndex].ulPriority = xTasks[xIndex].ulPriority;
+		}
+		return iSchedulable;
+	}
+
+	/* RMS and DM priorities as the simulator assigns them. */
+	{
+		SchedSim_t xSim;
+
+		memset(&xSim, 0, sizeof(xSim));
+		xSim.pxTasks = pxTasks;
+		xSim.xTaskCount = xExp.xTaskCount;
+		xSim.ucPolicy = (uint8_t)iPolicy;
+		vSchedSimInit(&xSim);
+	}
+	for (xIndex = 0; xIndex < xExp.xTaskCount; xIndex++)
+	{
+		xTasks[xIndex].ulPriority = pxTasks[xIndex].ulPriority;
+	}
+
+	return 0 == xSchedAnalysisFixedPriority(xTasks, xExp.xTaskCount, xExp.xResourceCount);
+}
+
+static void *prvWorker(void *pvParameters)
+{
+	static const int iPolicies[expPOLICY_COUNT] = { schedSIM_POLICY_RMS, schedSIM_POLICY_DM, schedSIM_POLICY_FIXED, schedSIM_POLICY_EDF };
+	static const int iProtocols[expPROTOCOL_COUNT] = { schedSIM_PROTOCOL_OPCP, schedSIM_PROTOCOL_IPCP };
+	uint32_t ulItemCount = (uint32_t)xExp.xPointCount * xExp.ulSetsPerPoint;
+	SchedSimTask_t xTasks[expMAX_TASKS];
+
+	(void)pvParameters;
+
+	for (;;)
+	{
+		uint32_t ulItem = __atomic_fetch_add(&xExp.ulNextItem, 1, __ATOMIC_RELAXED);
+		size_t xPoint;
+		int iPolicy, iProtocol;
+
+		if (ulItem >= ulItemCount)
+		{
+			break;
+		}
+		xPoint = ulItem / xExp.ulSetsPerPoint;
+
+		prvGenerateTaskSet(xPoint, ulItem % xExp.ulSetsPerPoint, xTasks);
+		for (iPolicy = 0; iPolicy < expPOLICY_COUNT; iPolicy++)
+		{
+			int iSchedulable = prvAnalyse(xTasks, iPolicies[iPolicy]);
+
+			for (iProtocol = 0; iProtocol < expPROTOCOL_COUNT; iProtocol++)
+			{
+				Result_t *pxResult = &xResults[xPoint][iPolicy * expPROTOCOL_COUNT + iProtocol];
+				SchedSim_t xSim;
+				uint32_t ulMisses, ulJobs = 0;
+				size_t xIndex;
+
+				memset(&xSim, 0, sizeof(xSim));
+				xSim.pxTasks = xTasks;
+				xSim.xTaskCount = xExp.xTaskCount;
+				xSim.xResourceCount = xExp.xResourceCount;
+				xSim.ucPolicy = (uint8_t)iPolicies[iPolicy];
+				xSim.ucProtocol = (uint8_t)iProtocols[iProtocol];
+				xSim.ulSeed = ulItem + 1;
+				vSchedSimInit(&xSim);
+				ulMisses = ulSchedSimRun(&xSim, xExp.ullSimTime);
+				for (xIndex = 0; xIndex < xExp.xTaskCount; xIndex++)
+				{
+					ulJobs += xTasks[xIndex].ulJobs + xTasks[xIndex].ulAbortedJobs;
+				}
+
+				if (iSchedulable)
+				{
+					__atomic_fetch_add(&pxResult->ulAnalysisSchedulable, 1, __ATOMIC_RELAXED);
+				}
+				if (0 == ulMisses)
+				{
+					__atomic_fetch_add(&pxResult->ulSimulationSchedulable, 1, __ATOMIC_RELAXED);
+				}
+				__atomic_fetch_add(&pxResult->ullMisses, ulMisses, __ATOMIC_RELAXED);
+				__atomic_fetch_add(&pxResult->ullJobs, ulJobs, __ATOMIC_RELAXED);
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static int prvParseRange(const char *pcText, double *pdFrom, double *pdTo, double *pdStep)
+{
+	return (NULL == pdStep) ? (2 == sscanf(pcText, "%lf:%lf", pdFrom, pdTo)) : (3 == sscanf(pcText, "%lf:%lf:%lf", pdFrom, pdTo, pdStep));
+}
+
+static void prvUsage(const char *pcName)
+{
+	fprintf(stderr, "usage: %s [-n tasks] [-r resources] [-u from:to:step] [-s sets] [-g uunifast|randfixedsum]\n"
+			"          [-p uniform|loguniform|harmonic] [-P min:max] [-d min:max] [-c probability]\n"
+			"          [-l fraction] [-e fraction] [-T time] [-x seed] [-j threads] [-t]\n", pcName);
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t xThreads[256];
+	double dPeriodMin = 10.0, dPeriodMax = 1000.0;
+	size_t xPoint;
+	unsigned uThread, uFailures;
+	int iOption, iConfig;
+
+	xExp.xTaskCount = 5;
+	xExp.xResourceCount = 2;
+	xExp.dUtilFrom = 0.05;
+	xExp.dUtilTo = 1.0;
+	xExp.dUtilStep = 0.05;
+	xExp.ulSetsPerPoint = 1000;
+	xExp.iGenerator = expGEN_UUNIFAST;
+	xExp.iPeriodDistribution = expPERIOD_LOGUNIFORM;
+	xExp.dDeadlineMin = 1.0;
+	xExp.dDeadlineMax = 1.0;
+	xExp.dResourceProbability = 0.3;
+	xExp.dCriticalSectionMax = 0.2;
+	xExp.dExecTimeMin = 1.0;
+	xExp.ullSeed = 1;
+	xExp.uThreads = (unsigned)sysconf(_SC_NPROCESSORS_ONLN);
+
+	while (-1 != (iOption = getopt(argc, argv, "n:r:u:s:g:p:P:d:c:l:e:T:x:j:t")))
+	{
+		int iValid = 1;
+
+		switch (iOption)
+		{
+			case 'n': xExp.xTaskCount = strtoul(optarg, NULL, 0); break;
+			case 'r': xExp.xResourceCount = strtoul(optarg, NULL, 0); break;
+			case 'u': iValid = prvParseRange(optarg, &xExp.dUtilFrom, &xExp.dUtilTo, &xExp.dUtilStep); break;
+			case 's': xExp.ulSetsPerPoint = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 'g': xExp.iGenerator = (0 == strcmp(optarg, "randfixedsum")) ? expGEN_RANDFIXEDSUM : expGEN_UUNIFAST; break;
+			case 'p':
+				xExp.iPeriodDistribution = (0 == strcmp(optarg, "uniform")) ? expPERIOD_UNIFORM : (0 == strcmp(optarg, "harmonic")) ? expPERIOD_HARMONIC : expPERIOD_LOGUNIFORM;
+				break;
+			case 'P': iValid = prvParseRange(optarg, &dPeriodMin, &dPeriodMax, NULL); break;
+			case 'd': iValid = prvParseRange(optarg, &xExp.dDeadlineMin, &xExp.dDeadlineMax, NULL); break;
+			case 'c': xExp.dResourceProbability = atof(optarg); break;
+			case 'l': xExp.dCriticalSectionMax = atof(optarg); break;
+			case 'e': xExp.dExecTimeMin = atof(optarg); break;
+			case 'T': xExp.ullSimTime = strtoull(optarg, NULL, 0); break;
+			case 'x': xExp.ullSeed = strtoull(optarg, NULL, 0); break;
+			case 'j': xExp.uThreads = (unsigned)strtoul(optarg, NULL, 0); break;
+			case 't':
+				uFailures = prvCheckGenerators();
+				printf("generators: %u failures\n", uFailures);
+				return (0 == uFailures) ? 0 : 1;
+			default: iValid = 0; break;
+		}
+		if (!iValid)
+		{
+			prvUsage(argv[0]);
+			return 2;
+		}
+	}
+
+	xExp.ulPeriodMin = (uint32_t)dPeriodMin;
+	xExp.ulPeriodMax = (uint32_t)dPeriodMax;
+	xExp.xPointCount = (xExp.dUtilStep > 0.0) ? (size_t)((xExp.dUtilTo - xExp.dUtilFrom) / xExp.dUtilStep + 1.5) : 1;
+	if (0 == xExp.xTaskCount || xExp.xTaskCount > expMAX_TASKS || xExp.xResourceCount > schedANALYSIS_MAX_RESOURCES ||
+		0 == xExp.ulPeriodMin || xExp.ulPeriodMax < xExp.ulPeriodMin || xExp.xPointCount > expMAX_POINTS ||
+		xExp.dDeadlineMin < 0.0 || xExp.dDeadlineMax > 1.0 || xExp.dDeadlineMax < xExp.dDeadlineMin)
+	{
+		prvUsage(argv[0]);
+		return 2;
+	}
+	if (0 == xExp.ullSimTime)
+	{
+		xExp.ullSimTime = 10ULL * xExp.ulPeriodMax;
+	}
+	if (0 == xExp.uThreads)
+	{
+		xExp.uThreads = 1;
+	}
+	if (xExp.uThreads > sizeof(xThreads) / sizeof(xThreads[0]))
+	{
+		xExp.uThreads = sizeof(xThreads) / sizeof(xThreads[0]);
+	}
+
+	for (uThread = 0; uThread < xExp.uThreads; uThread++)
+	{
+		if (0 != pthread_create(&xThreads[uThread], NULL, prvWorker, NULL))
+		{
+			perror("pthread_create");
+			return 1;
+		}
+	}
+	for (uThread = 0; uThread < xExp.uThreads; uThread++)
+	{
+		pthread_join(xThreads[uThread], NULL);
+	}
+
+	printf("utilization,policy,protocol,sets,analysis_ratio,simulation_ratio,miss_rate\n");
+	for (xPoint = 0; xPoint < xExp.xPointCount; xPoint++)
+	{
+		for (iConfig = 0; iConfig < expCONFIG_COUNT; iConfig++)
+		{
+			const Result_t *pxResult = &xResults[xPoint][iConfig];
+
+			printf("%.4f,%s,%s,%u,%.4f,%.4f,%.6f\n", xExp.dUtilFrom + (double)xPoint * xExp.dUtilStep, pcPolicyNames[iConfig / expPROTOCOL_COUNT],
+				   pcProtocolNames[iConfig % expPROTOCOL_COUNT], xExp.ulSetsPerPoint, (double)pxResult->ulAnalysisSchedulable / xExp.ulSetsPerPoint,
+				   (double)pxResult->ulSimulationSchedulable / xExp.ulSetsPerPoint, pxResult->ullJobs ? (double)pxResult->ullMisses / (double)pxResult->ullJobs : 0.0);
+		}
+	}
+
+	return 0;
+}
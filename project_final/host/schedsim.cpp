@@ -0,0 +1,554 @@
+#include "schedsim.h"
+
+#define schedSIM_NONE (-1)
+
+/* Returns the rank of task xIndex by period or relative deadline, the largest
+ * rank for the shortest one. Equal keys get consecutive ranks, the lower index
+ * ranking higher, if xUnique is set and the same rank otherwise. */
+static uint32_t prvRank(const SchedSim_t *pxSim, size_t xIndex, int xByPeriod, int xUnique)
+{
+	const SchedSimTask_t *pxTasks = pxSim->pxTasks;
+	uint32_t ulKey = xByPeriod ? pxTasks[xIndex].ulPeriod : pxTasks[xIndex].ulDeadline;
+	uint32_t ulRank = 1;
+	size_t xOther;
+
+	for (xOther = 0; xOther < pxSim->xTaskCount; xOther++)
+	{
+		uint32_t ulOtherKey = xByPeriod ? pxTasks[xOther].ulPeriod : pxTasks[xOther].ulDeadline;
+
+		if (ulOtherKey > ulKey || (xUnique && ulOtherKey == ulKey && xOther > xIndex))
+		{
+			ulRank++;
+		}
+	}
+
+	return ulRank;
+}
+
+void vSchedSimInit(SchedSim_t *pxSim)
+{
+	SchedSimTask_t *pxTasks = pxSim->pxTasks;
+	size_t xIndex, xResource;
+
+	/* Priorities as prvSetFixedPriorities, preemption levels as the EDF
+	 * blocking analysis. */
+	for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+	{
+		if (schedSIM_POLICY_RMS == pxSim->ucPolicy)
+		{
+			pxTasks[xIndex].ulPriority = prvRank(pxSim, xIndex, 1, 1);
+		}
+		else if (schedSIM_POLICY_DM == pxSim->ucPolicy)
+		{
+			pxTasks[xIndex].ulPriority = prvRank(pxSim, xIndex, 0, 1);
+		}
+	}
+	for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+	{
+		SchedSimTask_t *pxTask = &pxTasks[xIndex];
+
+		pxTask->ulLevel = (schedSIM_POLICY_EDF == pxSim->ucPolicy) ? prvRank(pxSim, xIndex, 0, 0) : pxTask->ulPriority;
+		pxTask->ulJobs = 0;
+		pxTask->ulDeadlineMisses = 0;
+		pxTask->ulAbortedJobs = 0;
+		pxTask->ulSkippedJobs = 0;
+		pxTask->ulOverruns = 0;
+		pxTask->ulMaxResponseTime = 0;
+		pxTask->ullNextRelease = pxTask->ulPhase;
+		pxTask->sHeldResource = schedSIM_NONE;
+		pxTask->sBlockedBy = schedSIM_NONE;
+		pxTask->ucActive = 0;
+		pxTask->ucDegraded = 0;
+	}
+
+	for (xResource = 0; xResource < pxSim->xResourceCount; xResource++)
+	{
+		pxSim->ulCeiling[xResource] = 0;
+		pxSim->sHolder[xResource] = schedSIM_NONE;
+		for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+		{
+			if (pxTasks[xIndex].ulCriticalSection[xResource] > 0 && pxTasks[xIndex].ulLevel > pxSim->ulCeiling[xResource])
+			{
+				pxSim->ulCeiling[xResource] = pxTasks[xIndex].ulLevel;
+			}
+		}
+	}
+
+	pxSim->ullNow = 0;
+	pxSim->ullBusyTime = 0;
+	pxSim->ulEvents = 0;
+	pxSim->ulContextSwitches = 0;
+	pxSim->ulPreemptions = 0;
+	pxSim->sRunning = schedSIM_NONE;
+	if (0 == pxSim->ulSeed)
+	{
+		pxSim->ulSeed = 1;
+	}
+}
+
+/* Returns the first resource from xResource on that the task uses. */
+static int16_t prvNextResource(const SchedSim_t *pxSim, const SchedSimTask_t *pxTask, size_t xResource)
+{
+	for (; xResource < pxSim->xResourceCount; xResource++)
+	{
+		if (pxTask->ulCriticalSection[xResource] > 0)
+		{
+			return (int16_t)xResource;
+		}
+	}
+
+	return schedSIM_NONE;
+}
+
+static uint32_t prvDrawExecTime(SchedSim_t *pxSim, size_t xIndex)
+{
+	const SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	uint32_t ulRandom;
+
+	if (pxTask->ucDegraded)
+	{
+		return pxTask->ulDegradedExecTime;
+	}
+	if (NULL != pxSim->pxExecTimeFunction)
+	{
+		return pxSim->pxExecTimeFunction(pxSim->pvExecTimeContext, pxTask, xIndex);
+	}
+	if (pxTask->ulExecTimeMax <= pxTask->ulExecTimeMin)
+	{
+		return pxTask->ulExecTimeMin;
+	}
+
+	/* xorshift32 */
+	ulRandom = pxSim->ulSeed;
+	ulRandom ^= ulRandom << 13;
+	ulRandom ^= ulRandom >> 17;
+	ulRandom ^= ulRandom << 5;
+	pxSim->ulSeed = ulRandom;
+
+	return pxTask->ulExecTimeMin + ulRandom % (pxTask->ulExecTimeMax - pxTask->ulExecTimeMin + 1);
+}
+
+static void prvReleaseJob(SchedSim_t *pxSim, size_t xIndex)
+{
+	SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	uint32_t ulCritical = 0;
+	size_t xResource;
+
+	for (xResource = 0; xResource < pxSim->xResourceCount; xResource++)
+	{
+		ulCritical += pxTask->ulCriticalSection[xResource];
+	}
+
+	pxTask->ullRelease = pxTask->ullNextRelease;
+	pxTask->ullAbsDeadline = pxTask->ullRelease + pxTask->ulDeadline;
+	pxTask->ullNextRelease += pxTask->ulPeriod;
+	pxTask->ulExecuted = 0;
+	pxTask->ulDemand = prvDrawExecTime(pxSim, xIndex);
+	if (pxTask->ulDemand < ulCritical)
+	{
+		pxTask->ulDemand = ulCritical;
+	}
+	pxTask->sNextResource = prvNextResource(pxSim, pxTask, 0);
+	pxTask->ulNextStop = (schedSIM_NONE != pxTask->sNextResource) ? (pxTask->ulDemand - ulCritical) / 2 : pxTask->ulDemand;
+	pxTask->sHeldResource = schedSIM_NONE;
+	pxTask->sBlockedBy = schedSIM_NONE;
+	pxTask->ucActive = 1;
+	pxTask->ucStarted = 0;
+	pxTask->ucMissed = 0;
+}
+
+/* Releases the resource held by task xIndex and wakes the tasks it blocked. */
+static void prvUnlock(SchedSim_t *pxSim, size_t xIndex)
+{
+	SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	size_t xOther;
+
+	if (schedSIM_NONE != pxTask->sHeldResource)
+	{
+		pxSim->sHolder[pxTask->sHeldResource] = schedSIM_NONE;
+		pxTask->sHeldResource = schedSIM_NONE;
+	}
+	for (xOther = 0; xOther < pxSim->xTaskCount; xOther++)
+	{
+		if ((int16_t)xIndex == pxSim->pxTasks[xOther].sBlockedBy)
+		{
+			pxSim->pxTasks[xOther].sBlockedBy = schedSIM_NONE;
+		}
+	}
+}
+
+static void prvEndJob(SchedSim_t *pxSim, size_t xIndex)
+{
+	prvUnlock(pxSim, xIndex);
+	pxSim->pxTasks[xIndex].ucActive = 0;
+	pxSim->pxTasks[xIndex].sBlockedBy = schedSIM_NONE;
+}
+
+/* Returns the priority task xIndex runs at: its own, raised to the ceiling of
+ * a held resource under IPCP and to the priority of the tasks it blocks. */
+static uint32_t prvActivePriority(const SchedSim_t *pxSim, size_t xIndex)
+{
+	const SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	uint32_t ulPriority = pxTask->ulLevel;
+	size_t xOther;
+
+	if (schedSIM_PROTOCOL_IPCP == pxSim->ucProtocol && schedSIM_NONE != pxTask->sHeldResource && pxSim->ulCeiling[pxTask->sHeldResource] > ulPriority)
+	{
+		ulPriority = pxSim->ulCeiling[pxTask->sHeldResource];
+	}
+	/* Blocked tasks hold no resource and are not blocked themselves, their
+	 * priority is their own. */
+	for (xOther = 0; xOther < pxSim->xTaskCount; xOther++)
+	{
+		if ((int16_t)xIndex == pxSim->pxTasks[xOther].sBlockedBy && pxSim->pxTasks[xOther].ulLevel > ulPriority)
+		{
+			ulPriority = pxSim->pxTasks[xOther].ulLevel;
+		}
+	}
+
+	return ulPriority;
+}
+
+/* Returns the holder of the resource with the highest ceiling held by a task
+ * other than xIndex, and that ceiling in pulCeiling. */
+static int16_t prvSystemCeiling(const SchedSim_t *pxSim, size_t xIndex, uint32_t *pulCeiling)
+{
+	int16_t sHolder = schedSIM_NONE;
+	size_t xResource;
+
+	*pulCeiling = 0;
+	for (xResource = 0; xResource < pxSim->xResourceCount; xResource++)
+	{
+		if (schedSIM_NONE != pxSim->sHolder[xResource] && (int16_t)xIndex != pxSim->sHolder[xResource] && pxSim->ulCeiling[xResource] >= *pulCeiling)
+		{
+			*pulCeiling = pxSim->ulCeiling[xResource];
+			sHolder = pxSim->sHolder[xResource];
+		}
+	}
+
+	return sHolder;
+}
+
+/* Task xIndex requests its next resource. Under OPCP with fixed priorities the
+ * request is granted only above the system ceiling, as vRequestResource does.
+ * Otherwise the task waits for the holder. */
+static void prvLock(SchedSim_t *pxSim, size_t xIndex)
+{
+	SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	int16_t sResource = pxTask->sNextResource;
+	int16_t sBlocker = pxSim->sHolder[sResource];
+	uint32_t ulCeiling;
+
+	if (schedSIM_NONE == sBlocker && schedSIM_PROTOCOL_OPCP == pxSim->ucProtocol && schedSIM_POLICY_EDF != pxSim->ucPolicy)
+	{
+		int16_t sHolder = prvSystemCeiling(pxSim, xIndex, &ulCeiling);
+
+		if (schedSIM_NONE != sHolder && prvActivePriority(pxSim, xIndex) <= ulCeiling)
+		{
+			sBlocker = sHolder;
+		}
+	}
+
+	if (schedSIM_NONE != sBlocker)
+	{
+		pxTask->sBlockedBy = sBlocker;
+		return;
+	}
+
+	pxSim->sHolder[sResource] = (int16_t)xIndex;
+	pxTask->sHeldResource = sResource;
+	pxTask->sNextResource = prvNextResource(pxSim, pxTask, sResource + 1);
+	pxTask->ulNextStop = pxTask->ulExecuted + pxTask->ulCriticalSection[sResource];
+}
+
+static void prvCompleteJob(SchedSim_t *pxSim, size_t xIndex)
+{
+	SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	uint64_t ullResponse = pxSim->ullNow - pxTask->ullRelease;
+
+	pxTask->ulJobs++;
+	if (ullResponse > pxTask->ulMaxResponseTime)
+	{
+		pxTask->ulMaxResponseTime = (ullResponse > 0xFFFFFFFFULL) ? 0xFFFFFFFFUL : (uint32_t)ullResponse;
+	}
+
+	/* Deadline miss policy of the task loop in scheduler.cpp. */
+	if (pxTask->ucMissed)
+	{
+		if (schedSIM_MISS_SKIP_NEXT == pxTask->ucMissPolicy)
+		{
+			pxTask->ullNextRelease += pxTask->ulPeriod;
+			pxTask->ulSkippedJobs++;
+		}
+		else if (schedSIM_MISS_DEGRADE == pxTask->ucMissPolicy)
+		{
+			pxTask->ucDegraded = 1;
+		}
+	}
+	else
+	{
+		pxTask->ucDegraded = 0;
+	}
+
+	prvEndJob(pxSim, xIndex);
+}
+
+/* Handles task xIndex reaching its next stop. Returns 1 if the job ended. */
+static int prvStop(SchedSim_t *pxSim, size_t xIndex)
+{
+	SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+
+	if (schedSIM_NONE != pxTask->sHeldResource)
+	{
+		prvUnlock(pxSim, xIndex);
+		pxTask->ulNextStop = (schedSIM_NONE != pxTask->sNextResource) ? pxTask->ulExecuted : pxTask->ulDemand;
+		return 0;
+	}
+	if (schedSIM_NONE != pxTask->sNextResource)
+	{
+		prvLock(pxSim, xIndex);
+		return 0;
+	}
+
+	prvCompleteJob(pxSim, xIndex);
+	return 1;
+}
+
+/* Returns 1 if task xIndex has reached its next stop or the end of its budget. */
+static int prvAtStop(const SchedSim_t *pxSim, size_t xIndex)
+{
+	const SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+
+	return pxTask->ulExecuted == pxTask->ulNextStop || (pxSim->ucEnforceBudget && pxTask->ulExecuted >= pxTask->ulExecTime);
+}
+
+/* Lets task xIndex pass the stop it has reached. The next stop may be at the
+ * same time, but a task woken by a release runs first if it has a higher
+ * priority. Returns 1 if the job ended. */
+static int prvPassStop(SchedSim_t *pxSim, size_t xIndex)
+{
+	SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+
+	if (pxTask->ulExecuted == pxTask->ulNextStop)
+	{
+		return prvStop(pxSim, xIndex);
+	}
+
+	pxTask->ulOverruns++;
+	prvEndJob(pxSim, xIndex);
+	return 1;
+}
+
+/* Returns 1 if task xIndex runs before task xOther. Ties keep the running
+ * task, then go to the earlier release and the lower index. */
+static int prvRunsBefore(const SchedSim_t *pxSim, size_t xIndex, size_t xOther)
+{
+	const SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+	const SchedSimTask_t *pxOther = &pxSim->pxTasks[xOther];
+
+	if (schedSIM_POLICY_EDF == pxSim->ucPolicy)
+	{
+		if (pxTask->ullAbsDeadline != pxOther->ullAbsDeadline)
+		{
+			return pxTask->ullAbsDeadline < pxOther->ullAbsDeadline;
+		}
+	}
+	else
+	{
+		uint32_t ulPriority = prvActivePriority(pxSim, xIndex);
+		uint32_t ulOtherPriority = prvActivePriority(pxSim, xOther);
+
+		if (ulPriority != ulOtherPriority)
+		{
+			return ulPriority > ulOtherPriority;
+		}
+	}
+
+	if ((int16_t)xIndex == pxSim->sRunning || (int16_t)xOther == pxSim->sRunning)
+	{
+		return (int16_t)xIndex == pxSim->sRunning;
+	}
+	if (pxTask->ullRelease != pxOther->ullRelease)
+	{
+		return pxTask->ullRelease < pxOther->ullRelease;
+	}
+
+	return xIndex < xOther;
+}
+
+/* Returns the task to run, or schedSIM_NONE if the processor idles. Under EDF
+ * a job starts only above the preemption level ceiling of the held resources. */
+static int16_t prvPickTask(const SchedSim_t *pxSim)
+{
+	int16_t sBest = schedSIM_NONE;
+	uint32_t ulCeiling = 0;
+	size_t xIndex;
+
+	if (schedSIM_POLICY_EDF == pxSim->ucPolicy)
+	{
+		(void)prvSystemCeiling(pxSim, pxSim->xTaskCount, &ulCeiling);
+	}
+
+	for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+	{
+		const SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+
+		if (!pxTask->ucActive || schedSIM_NONE != pxTask->sBlockedBy)
+		{
+			continue;
+		}
+		if (schedSIM_POLICY_EDF == pxSim->ucPolicy && !pxTask->ucStarted && pxTask->ulLevel <= ulCeiling)
+		{
+			continue;
+		}
+		if (schedSIM_NONE == sBest || prvRunsBefore(pxSim, xIndex, (size_t)sBest))
+		{
+			sBest = (int16_t)xIndex;
+		}
+	}
+
+	return sBest;
+}
+
+/* Marks jobs that passed their deadline. Returns the number of new misses. */
+static uint32_t prvCheckDeadlines(SchedSim_t *pxSim)
+{
+	uint32_t ulMisses = 0;
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+	{
+		SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+
+		if (pxTask->ucActive && !pxTask->ucMissed && pxTask->ullAbsDeadline <= pxSim->ullNow)
+		{
+			pxTask->ucMissed = 1;
+			pxTask->ulDeadlineMisses++;
+			ulMisses++;
+			if (schedSIM_MISS_ABORT == pxTask->ucMissPolicy)
+			{
+				pxTask->ulAbortedJobs++;
+				prvEndJob(pxSim, xIndex);
+			}
+		}
+	}
+
+	return ulMisses;
+}
+
+uint32_t ulSchedSimRun(SchedSim_t *pxSim, uint64_t ullDuration)
+{
+	uint64_t ullEnd = pxSim->ullNow + ullDuration;
+	uint32_t ulMisses = 0;
+	size_t xIndex;
+
+	for (;;)
+	{
+		int16_t sRunning;
+		uint64_t ullNext = ullEnd;
+		int xJobEnded = 0;
+
+		/* A job whose deadline is now misses it before the next job of the
+		 * same task is released, a caught up release may be late already. */
+		ulMisses += prvCheckDeadlines(pxSim);
+		for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+		{
+			if (!pxSim->pxTasks[xIndex].ucActive && pxSim->pxTasks[xIndex].ullNextRelease <= pxSim->ullNow)
+			{
+				prvReleaseJob(pxSim, xIndex);
+			}
+		}
+		ulMisses += prvCheckDeadlines(pxSim);
+
+		/* Let the chosen task pass its stops at this time until it can run. */
+		for (;;)
+		{
+			sRunning = prvPickTask(pxSim);
+			if (schedSIM_NONE == sRunning || !prvAtStop(pxSim, (size_t)sRunning))
+			{
+				break;
+			}
+			pxSim->pxTasks[sRunning].ucStarted = 1;
+			if (prvPassStop(pxSim, (size_t)sRunning))
+			{
+				xJobEnded = 1;
+				break;
+			}
+		}
+		if (schedSIM_NONE != sRunning)
+		{
+			pxSim->pxTasks[sRunning].ucStarted = 1;
+		}
+		pxSim->ulEvents++;
+		if (xJobEnded)
+		{
+			/* Releases caught up after the job are due now. */
+			continue;
+		}
+		if (pxSim->ullNow >= ullEnd)
+		{
+			break;
+		}
+
+		if (sRunning != pxSim->sRunning)
+		{
+			int16_t sPrevious = pxSim->sRunning;
+
+			if (schedSIM_NONE != sPrevious && pxSim->pxTasks[sPrevious].ucActive && schedSIM_NONE == pxSim->pxTasks[sPrevious].sBlockedBy)
+			{
+				pxSim->ulPreemptions++;
+			}
+			if (schedSIM_NONE != sRunning)
+			{
+				pxSim->ulContextSwitches++;
+			}
+			pxSim->sRunning = sRunning;
+		}
+
+		/* Jump to the next release, deadline or stop of the running job. */
+		for (xIndex = 0; xIndex < pxSim->xTaskCount; xIndex++)
+		{
+			const SchedSimTask_t *pxTask = &pxSim->pxTasks[xIndex];
+
+			if (!pxTask->ucActive && pxTask->ullNextRelease < ullNext)
+			{
+				ullNext = pxTask->ullNextRelease;
+			}
+			if (pxTask->ucActive && !pxTask->ucMissed && pxTask->ullAbsDeadline < ullNext)
+			{
+				ullNext = pxTask->ullAbsDeadline;
+			}
+		}
+		if (schedSIM_NONE != sRunning)
+		{
+			SchedSimTask_t *pxTask = &pxSim->pxTasks[sRunning];
+			uint32_t ulStop = pxTask->ulNextStop;
+
+			if (pxSim->ucEnforceBudget && pxTask->ulExecTime < ulStop)
+			{
+				ulStop = pxTask->ulExecTime;
+			}
+			if (pxSim->ullNow + (ulStop - pxTask->ulExecuted) < ullNext)
+			{
+				ullNext = pxSim->ullNow + (ulStop - pxTask->ulExecuted);
+			}
+			pxTask->ulExecuted += (uint32_t)(ullNext - pxSim->ullNow);
+			pxSim->ullBusyTime += ullNext - pxSim->ullNow;
+			pxSim->ullNow = ullNext;
+
+			/* A job that releases a resource or completes at a release or
+			 * deadline does so first. A completion right after the release of
+			 * the last resource is part of the same stop. */
+			if (prvAtStop(pxSim, (size_t)sRunning) && !prvPassStop(pxSim, (size_t)sRunning))
+			{
+				if (schedSIM_NONE == pxTask->sNextResource && prvAtStop(pxSim, (size_t)sRunning))
+				{
+					(void)prvPassStop(pxSim, (size_t)sRunning);
+				}
+			}
+		}
+		pxSim->ullNow = ullNext;
+	}
+
+	return ulMisses;
+}
@@ -0,0 +1,128 @@
+#ifndef SCHEDSIM_H_
+#define SCHEDSIM_H_
+
+/* Discrete-event simulation of the periodic task scheduler. The simulation
+ * follows the rules of scheduler.cpp (fixed priorities or EDF, OPCP or IPCP,
+ * deadline miss policies and execution time budgets) but jumps from event to
+ * event instead of waiting for ticks, so long hyperperiods of many task sets
+ * can be checked on the host. All state lives in the caller's structures, so
+ * independent simulations can run in parallel threads. All times are given in
+ * the same unit, usually software ticks. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../schedanalysis.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Scheduling policies, numbered as in scheduler.h. Under
+ * schedSIM_POLICY_FIXED the priorities are taken from the tasks, for example
+ * as set by xSchedAnalysisAudsley. */
+#define schedSIM_POLICY_RMS		1
+#define schedSIM_POLICY_DM		2
+#define schedSIM_POLICY_EDF		3
+#define schedSIM_POLICY_FIXED	4
+
+/* Resource access protocols, numbered as in scheduler.h. Under EDF all of them
+ * use preemption levels ordered by relative deadline (stack resource policy),
+ * see vSchedAnalysisSetEDFBlocking. schedSIM_PROTOCOL_SRP is for EDF only. */
+#define schedSIM_PROTOCOL_OPCP	1
+#define schedSIM_PROTOCOL_IPCP	2
+#define schedSIM_PROTOCOL_SRP	3
+
+/* Deadline miss policies, numbered as schedDEADLINE_MISS_* in scheduler.h. */
+#define schedSIM_MISS_ABORT		1
+#define schedSIM_MISS_SKIP_NEXT	2
+#define schedSIM_MISS_CONTINUE	3
+#define schedSIM_MISS_DEGRADE	4
+
+/* Description of one periodic task and its simulation state. A job executes
+ * half of its time outside critical sections, then the critical sections of
+ * its resources one after another in resource order, then the rest. A job
+ * executes at least the sum of its critical sections. */
+typedef struct xSchedSimTask
+{
+	uint32_t ulPhase;			/* Release time of the first job. */
+	uint32_t ulPeriod;			/* Time between two releases, not 0. */
+	uint32_t ulDeadline;		/* Relative deadline, not above the period. */
+	uint32_t ulExecTime;		/* Worst-case execution time, the budget of a job. */
+	uint32_t ulExecTimeMin;		/* Execution times are drawn uniformly from */
+	uint32_t ulExecTimeMax;		/* [ulExecTimeMin, ulExecTimeMax], may exceed ulExecTime. */
+	uint32_t ulDegradedExecTime;	/* Execution time of a degraded job. */
+	uint32_t ulPriority;		/* Fixed priority, a larger value is a higher priority. Set by
+								 * vSchedSimInit under RMS and DM. */
+	uint32_t ulCriticalSection[ schedANALYSIS_MAX_RESOURCES ]; /* Time the task holds each resource, 0 if it is not used. */
+	uint8_t ucMissPolicy;		/* One of schedSIM_MISS_*. */
+
+	/* Results. */
+	uint32_t ulJobs;			/* Completed jobs, late ones included. */
+	uint32_t ulDeadlineMisses;	/* Jobs that missed their deadline. */
+	uint32_t ulAbortedJobs;		/* Jobs deleted at their deadline. */
+	uint32_t ulSkippedJobs;		/* Releases skipped after a late job. */
+	uint32_t ulOverruns;		/* Jobs stopped at the end of their budget. */
+	uint32_t ulMaxResponseTime;	/* Longest response time of a completed job. */
+
+	/* Simulation state, private. */
+	uint64_t ullNextRelease;
+	uint64_t ullRelease;
+	uint64_t ullAbsDeadline;
+	uint32_t ulExecuted;
+	uint32_t ulDemand;
+	uint32_t ulNextStop;
+	uint32_t ulLevel;
+	int16_t sHeldResource;
+	int16_t sNextResource;
+	int16_t sBlockedBy;
+	uint8_t ucActive;
+	uint8_t ucStarted;
+	uint8_t ucMissed;
+	uint8_t ucDegraded;
+} SchedSimTask_t;
+
+/* Draws the execution time of the next job of task xIndex. */
+typedef uint32_t (*SchedSimExecTimeFunction_t)(void *pvContext, const SchedSimTask_t *pxTask, size_t xIndex);
+
+typedef struct xSchedSim
+{
+	/* Parameters. */
+	SchedSimTask_t *pxTasks;
+	size_t xTaskCount;
+	size_t xResourceCount;
+	uint8_t ucPolicy;			/* One of schedSIM_POLICY_*. */
+	uint8_t ucProtocol;			/* One of schedSIM_PROTOCOL_*. */
+	uint8_t ucEnforceBudget;	/* Stop a job that exceeds ulExecTime until its next release,
+								 * as schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME does. */
+	uint32_t ulSeed;			/* Seed of the uniform execution time draw, not 0. */
+	SchedSimExecTimeFunction_t pxExecTimeFunction;	/* Replaces the uniform draw if not NULL. */
+	void *pvExecTimeContext;
+
+	/* Results. */
+	uint64_t ullNow;			/* Simulated time. */
+	uint64_t ullBusyTime;		/* Time a job was running. */
+	uint32_t ulEvents;			/* Processed events. */
+	uint32_t ulContextSwitches;	/* Changes of the running job. */
+	uint32_t ulPreemptions;		/* Context switches away from a job that could still run. */
+
+	/* Simulation state, private. */
+	uint32_t ulCeiling[ schedANALYSIS_MAX_RESOURCES ];
+	int16_t sHolder[ schedANALYSIS_MAX_RESOURCES ];
+	int16_t sRunning;
+} SchedSim_t;
+
+/* Prepares a simulation of the tasks set in pxSim at time 0: assigns
+ * priorities under RMS and DM, preemption levels under EDF, resource ceilings,
+ * and clears all results. Parameters of pxSim must be set before. */
+void vSchedSimInit(SchedSim_t *pxSim);
+
+/* Simulates the next ullDuration time units. Can be called repeatedly to
+ * continue a simulation. Returns the number of deadline misses in this run. */
+uint32_t ulSchedSimRun(SchedSim_t *pxSim, uint64_t ullDuration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDSIM_H_ */
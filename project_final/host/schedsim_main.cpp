@@ -0,0 +1,268 @@
+/* Command line front end of the discrete-event simulator.
+ *
+ *   schedsim [-p rms|dm|edf|opa] [-r opcp|ipcp|srp] [-b] [-s seed] [-t time] taskset
+ *
+ * -r srp needs -p edf. -b stops jobs at the end of their budget. -t is the
+ * simulated time, one hyperperiod by default. The task set file holds one task per line, '#'
+ * starts a comment:
+ *
+ *   name phase period deadline exec exec_min exec_max miss degraded_exec [cs1 cs2 ...]
+ *
+ * with miss one of abort, skip, continue, degrade and csN the time the task
+ * holds resource N, 0 if it does not use it. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "schedsim.h"
+#include "../schedanalysis.h"
+
+#define hostMAX_TASKS 64
+#define hostMAX_NAME_LEN 16
+
+static SchedSimTask_t xTasks[hostMAX_TASKS];
+static char cNames[hostMAX_TASKS][hostMAX_NAME_LEN];
+
+static int prvParseMissPolicy(const char *pcPolicy)
+{
+	static const char *const pcPolicies[] = { "abort", "skip", "continue", "degrade" };
+	int iPolicy;
+
+	for (iPolicy = 0; iPolicy < 4; iPolicy++)
+	{
+		if (0 == strcmp(pcPolicy, pcPolicies[iPolicy]))
+		{
+			return schedSIM_MISS_ABORT + iPolicy;
+		}
+	}
+
+	return -1;
+}
+
+/* Reads the task set. Returns the number of tasks, -1 on an error. */
+static int prvReadTaskSet(const char *pcPath, size_t *pxResourceCount)
+{
+	char cLine[256], cPolicy[16];
+	int iTasks = 0, iLine = 0;
+	FILE *pxFile = fopen(pcPath, "r");
+
+	if (NULL == pxFile)
+	{
+		perror(pcPath);
+		return -1;
+	}
+
+	*pxResourceCount = 0;
+	while (NULL != fgets(cLine, sizeof(cLine), pxFile))
+	{
+		SchedSimTask_t *pxTask = &xTasks[iTasks];
+		char *pcNext = strchr(cLine, '#');
+		int iUsed, iFields;
+		size_t xResource = 0;
+		unsigned long ulValue;
+
+		iLine++;
+		if (NULL != pcNext)
+		{
+			*pcNext = '\0';
+		}
+		if (strspn(cLine, " \t\r\n") == strlen(cLine))
+		{
+			continue;
+		}
+		if (hostMAX_TASKS == iTasks)
+		{
+			fprintf(stderr, "%s:%d: more than %d tasks\n", pcPath, iLine, hostMAX_TASKS);
+			fclose(pxFile);
+			return -1;
+		}
+
+		memset(pxTask, 0, sizeof(*pxTask));
+		iFields = sscanf(cLine, "%15s %u %u %u %u %u %u %15s %u%n", cNames[iTasks], &pxTask->ulPhase, &pxTask->ulPeriod, &pxTask->ulDeadline,
+						 &pxTask->ulExecTime, &pxTask->ulExecTimeMin, &pxTask->ulExecTimeMax, cPolicy, &pxTask->ulDegradedExecTime, &iUsed);
+		if (9 != iFields || 0 == pxTask->ulPeriod || pxTask->ulDeadline > pxTask->ulPeriod || prvParseMissPolicy(cPolicy) < 0)
+		{
+			fprintf(stderr, "%s:%d: invalid task\n", pcPath, iLine);
+			fclose(pxFile);
+			return -1;
+		}
+		pxTask->ucMissPolicy = (uint8_t)prvParseMissPolicy(cPolicy);
+
+		pcNext = cLine + iUsed;
+		while (1 == sscanf(pcNext, "%lu%n", &ulValue, &iUsed))
+		{
+			if (schedANALYSIS_MAX_RESOURCES == xResource)
+			{
+				fprintf(stderr, "%s:%d: more than %d resources\n", pcPath, iLine, schedANALYSIS_MAX_RESOURCES);
+				fclose(pxFile);
+				return -1;
+			}
+			pxTask->ulCriticalSection[xResource++] = (uint32_t)ulValue;
+			pcNext += iUsed;
+		}
+		if (xResource > *pxResourceCount)
+		{
+			*pxResourceCount = xResource;
+		}
+		iTasks++;
+	}
+
+	fclose(pxFile);
+	return iTasks;
+}
+
+/* Sets the priorities of Audsley's algorithm. Returns the number of tasks
+ * that could not be placed. */
+static size_t prvSetOPAPriorities(size_t xTaskCount, size_t xResourceCount)
+{
+	SchedAnalysisTask_t xAnalysis[hostMAX_TASKS];
+	size_t xIndex, xResource, xFailed;
+
+	memset(xAnalysis, 0, sizeof(xAnalysis));
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		xAnalysis[xIndex].ulPeriod = xTasks[xIndex].ulPeriod;
+		xAnalysis[xIndex].ulDeadline = xTasks[xIndex].ulDeadline;
+		xAnalysis[xIndex].ulExecTime = xTasks[xIndex].ulExecTime;
+		for (xResource = 0; xResource < xResourceCount; xResource++)
+		{
+			xSchedAnalysisAddResource(&xAnalysis[xIndex], xResource, xTasks[xIndex].ulCriticalSection[xResource]);
+		}
+	}
+
+	xFailed = xSchedAnalysisAudsley(xAnalysis, xTaskCount, xResourceCount);
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		xTasks[xIndex].ulPriority = xAnalysis[xIndex].ulPriority;
+	}
+
+	return xFailed;
+}
+
+static uint64_t prvGcd(uint64_t ullA, uint64_t ullB)
+{
+	while (0 != ullB)
+	{
+		uint64_t ullRest = ullA % ullB;
+
+		ullA = ullB;
+		ullB = ullRest;
+	}
+
+	return ullA;
+}
+
+int main(int argc, char **argv)
+{
+	SchedSim_t xSim;
+	const char *pcPolicy = "edf";
+	uint64_t ullDuration = 0;
+	struct timespec xStart, xEnd;
+	size_t xIndex, xResourceCount;
+	uint32_t ulMisses, ulJobs = 0;
+	int iOption, iTasks;
+
+	memset(&xSim, 0, sizeof(xSim));
+	xSim.ucProtocol = schedSIM_PROTOCOL_IPCP;
+	xSim.ulSeed = 1;
+
+	while (-1 != (iOption = getopt(argc, argv, "p:r:bs:t:")))
+	{
+		switch (iOption)
+		{
+			case 'p': pcPolicy = optarg; break;
+			case 'r':
+				xSim.ucProtocol = (0 == strcmp(optarg, "opcp")) ? schedSIM_PROTOCOL_OPCP : (0 == strcmp(optarg, "srp")) ? schedSIM_PROTOCOL_SRP : schedSIM_PROTOCOL_IPCP;
+				break;
+			case 'b': xSim.ucEnforceBudget = 1; break;
+			case 's': xSim.ulSeed = (uint32_t)strtoul(optarg, NULL, 0); break;
+			case 't': ullDuration = strtoull(optarg, NULL, 0); break;
+			default:
+				fprintf(stderr, "usage: %s [-p rms|dm|edf|opa] [-r opcp|ipcp|srp] [-b] [-s seed] [-t time] taskset\n", argv[0]);
+				return 2;
+		}
+	}
+	if (optind + 1 != argc)
+	{
+		fprintf(stderr, "usage: %s [-p rms|dm|edf|opa] [-r opcp|ipcp|srp] [-b] [-s seed] [-t time] taskset\n", argv[0]);
+		return 2;
+	}
+
+	iTasks = prvReadTaskSet(argv[optind], &xResourceCount);
+	if (iTasks <= 0)
+	{
+		return 1;
+	}
+
+	if (0 == strcmp(pcPolicy, "rms"))
+	{
+		xSim.ucPolicy = schedSIM_POLICY_RMS;
+	}
+	else if (0 == strcmp(pcPolicy, "dm"))
+	{
+		xSim.ucPolicy = schedSIM_POLICY_DM;
+	}
+	else if (0 == strcmp(pcPolicy, "opa"))
+	{
+		xSim.ucPolicy = schedSIM_POLICY_FIXED;
+		if (prvSetOPAPriorities((size_t)iTasks, xResourceCount) > 0)
+		{
+			printf("no feasible priority order\n");
+		}
+	}
+	else
+	{
+		xSim.ucPolicy = schedSIM_POLICY_EDF;
+	}
+	if (schedSIM_PROTOCOL_SRP == xSim.ucProtocol && schedSIM_POLICY_EDF != xSim.ucPolicy)
+	{
+		fprintf(stderr, "srp needs edf\n");
+		return 2;
+	}
+
+	/* One hyperperiod after the last phase by default. */
+	if (0 == ullDuration)
+	{
+		uint64_t ullPhase = 0;
+
+		ullDuration = 1;
+		for (xIndex = 0; xIndex < (size_t)iTasks; xIndex++)
+		{
+			ullDuration = ullDuration / prvGcd(ullDuration, xTasks[xIndex].ulPeriod) * xTasks[xIndex].ulPeriod;
+			if (xTasks[xIndex].ulPhase > ullPhase)
+			{
+				ullPhase = xTasks[xIndex].ulPhase;
+			}
+		}
+		ullDuration += ullPhase;
+	}
+
+	xSim.pxTasks = xTasks;
+	xSim.xTaskCount = (size_t)iTasks;
+	xSim.xResourceCount = xResourceCount;
+	vSchedSimInit(&xSim);
+
+	clock_gettime(CLOCK_MONOTONIC, &xStart);
+	ulMisses = ulSchedSimRun(&xSim, ullDuration);
+	clock_gettime(CLOCK_MONOTONIC, &xEnd);
+
+	printf("%-*s %8s %8s %8s %8s %8s %8s %10s\n", hostMAX_NAME_LEN, "task", "priority", "jobs", "misses", "aborted", "skipped", "overruns", "max resp");
+	for (xIndex = 0; xIndex < (size_t)iTasks; xIndex++)
+	{
+		const SchedSimTask_t *pxTask = &xTasks[xIndex];
+
+		printf("%-*s %8u %8u %8u %8u %8u %8u %10u\n", hostMAX_NAME_LEN, cNames[xIndex], pxTask->ulLevel, pxTask->ulJobs, pxTask->ulDeadlineMisses,
+			   pxTask->ulAbortedJobs, pxTask->ulSkippedJobs, pxTask->ulOverruns, pxTask->ulMaxResponseTime);
+		ulJobs += pxTask->ulJobs + pxTask->ulAbortedJobs + pxTask->ulOverruns;
+	}
+
+	printf("simulated time %llu, utilization %.3f, events %u, context switches %u, preemptions %u\n", (unsigned long long)xSim.ullNow,
+		   (double)xSim.ullBusyTime / (double)(xSim.ullNow ? xSim.ullNow : 1), xSim.ulEvents, xSim.ulContextSwitches, xSim.ulPreemptions);
+	printf("deadline miss rate %.6f (%u of %u jobs), wall time %.3f ms\n", ulJobs ? (double)ulMisses / ulJobs : 0.0, ulMisses, ulJobs,
+		   (xEnd.tv_sec - xStart.tv_sec) * 1e3 + (xEnd.tv_nsec - xStart.tv_nsec) / 1e6);
+
+	return (0 == ulMisses) ? 0 : 1;
+}
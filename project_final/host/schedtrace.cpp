@@ -0,0 +1,976 @@
+/* Decoder of the binary scheduler trace, see schedUSE_TRACE and ../schedtrace.h.
+ *
+ *   schedtrace [-f json|vcd] [-o output] [capture]
+ *
+ * Reads a capture of the serial output (stdin by default), rebuilds the job
+ * timeline of every task and writes it either as Chrome trace event JSON, which
+ * Perfetto and chrome://tracing open, or as a VCD for waveform viewers such as
+ * GTKWave. Text printed between trace frames is skipped. A summary of every
+ * task is printed to stderr. For example:
+ *
+ *   stty -F /dev/ttyACM0 9600 raw && cat /dev/ttyACM0 > capture.bin
+ *   ./build/schedtrace -o trace.json capture.bin
+ *
+ * In the JSON every task is a process with a track for the time it runs, one
+ * for its jobs (release to completion, with releases, deadlines, misses and
+ * overruns as instants) and one for the resources it holds or waits for.
+ * Times are exported in microseconds. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../schedtrace.h"
+
+#define traceMAX_TASKS		32
+#define traceMAX_NAME_LEN	32
+#define traceMAX_RESOURCES	16
+
+/* Kinds of timeline slices. */
+#define traceSLICE_RUN		0	/* The task runs. */
+#define traceSLICE_JOB		1	/* From the release of a job to its completion. */
+#define traceSLICE_HOLD		2	/* The task holds resource usArg. */
+#define traceSLICE_BLOCK	3	/* The task waits for resource usArg. */
+
+/* Kinds of timeline marks. */
+#define traceMARK_RELEASE	0
+#define traceMARK_DEADLINE	1	/* Absolute deadline of a job. */
+#define traceMARK_PREEMPT	2	/* Switched out while its job could still run. */
+#define traceMARK_MISS		3
+#define traceMARK_OVERRUN	4
+#define traceMARK_ABORT		5	/* The job was deleted and the task recreated. */
+#define traceMARK_PRIORITY	6	/* usArg: new priority. */
+#define traceMARK_DROPPED	7	/* usArg: records lost on the target. */
+
+typedef struct xTraceEvent
+{
+	uint64_t ullTime;		/* Microseconds since the first record. */
+	uint8_t ucEvent;
+	uint8_t ucTask;
+	uint16_t usArg;
+} TraceEvent_t;
+
+typedef struct xTraceSlice
+{
+	uint64_t ullStart;
+	uint64_t ullEnd;
+	uint32_t ulJob;
+	uint8_t ucTask;
+	uint8_t ucKind;
+	uint16_t usArg;
+} TraceSlice_t;
+
+typedef struct xTraceMark
+{
+	uint64_t ullTime;
+	uint32_t ulJob;
+	uint8_t ucTask;			/* schedTRACE_NO_TASK for marks of the whole system. */
+	uint8_t ucKind;
+	uint16_t usArg;
+} TraceMark_t;
+
+typedef struct xTraceTask
+{
+	/* Description sent by the target. */
+	char cName[ traceMAX_NAME_LEN + 1 ];
+	uint32_t ulPeriod;
+	uint32_t ulDeadline;
+	uint8_t ucSeen;
+
+	/* Results. */
+	uint32_t ulJobs;
+	uint32_t ulCompleted;
+	uint32_t ulMisses;
+	uint32_t ulOverruns;
+	uint32_t ulAborts;
+	uint32_t ulPreemptions;
+	uint64_t ullMaxResponse;
+
+	/* Timeline state. */
+	uint64_t ullRunStart;
+	uint64_t ullJobStart;
+	uint64_t ullBlockStart;
+	uint64_t ullHoldStart[ traceMAX_RESOURCES ];
+	uint16_t usHeld[ traceMAX_RESOURCES ];
+	uint16_t usBlockedOn;
+	uint8_t ucHeldCount;
+	uint8_t ucRunning;
+	uint8_t ucInJob;
+	uint8_t ucBlocked;
+	uint8_t ucStopped;
+} TraceTask_t;
+
+/* Growing array of fixed size elements. */
+typedef struct xTraceArray
+{
+	void *pvItems;
+	size_t xCount;
+	size_t xCapacity;
+} TraceArray_t;
+
+static TraceTask_t xTasks[traceMAX_TASKS];
+static TraceArray_t xEvents, xSlices, xMarks;
+static uint32_t ulTimeUnit = 1;		/* Microseconds per timestamp step. */
+static uint32_t ulTickPeriod = 0;	/* Microseconds per software tick. */
+static uint32_t ulDroppedRecords = 0;
+static size_t xSkippedBytes = 0;
+static uint16_t usResourceCount = 0;
+
+static void *prvArrayAdd(TraceArray_t *pxArray, size_t xSize)
+{
+	if (pxArray->xCount == pxArray->xCapacity)
+	{
+		size_t xCapacity = pxArray->xCapacity ? 2 * pxArray->xCapacity : 1024;
+		void *pvItems = realloc(pxArray->pvItems, xCapacity * xSize);
+
+		if (NULL == pvItems)
+		{
+			fprintf(stderr, "out of memory\n");
+			exit(1);
+		}
+		pxArray->pvItems = pvItems;
+		pxArray->xCapacity = xCapacity;
+	}
+
+	return (char *)pxArray->pvItems + xSize * pxArray->xCount++;
+}
+
+static uint8_t *prvReadAll(FILE *pxFile, size_t *pxSize)
+{
+	size_t xCapacity = 1 << 16, xSize = 0, xRead;
+	uint8_t *pucData = (uint8_t *)malloc(xCapacity);
+
+	while (NULL != pucData && 0 != (xRead = fread(pucData + xSize, 1, xCapacity - xSize, pxFile)))
+	{
+		xSize += xRead;
+		if (xSize == xCapacity)
+		{
+			xCapacity *= 2;
+			pucData = (uint8_t *)realloc(pucData, xCapacity);
+		}
+	}
+
+	*pxSize = xSize;
+	return pucData;
+}
+
+/* Accepts only records that a target could have sent, so that text which
+ * happens to contain the sync bytes is skipped. */
+static int prvRecordIsValid(const SchedTraceRecord_t *pxRecord)
+{
+	if (pxRecord->ucEvent < schedTRACE_START || pxRecord->ucEvent > schedTRACE_DROPPED)
+	{
+		return 0;
+	}
+	if (schedTRACE_NO_TASK == pxRecord->ucTask)
+	{
+		return schedTRACE_START == pxRecord->ucEvent || schedTRACE_TICK_PERIOD == pxRecord->ucEvent || schedTRACE_DROPPED == pxRecord->ucEvent;
+	}
+
+	return pxRecord->ucTask < traceMAX_TASKS && schedTRACE_START != pxRecord->ucEvent && schedTRACE_TICK_PERIOD != pxRecord->ucEvent &&
+		   schedTRACE_DROPPED != pxRecord->ucEvent;
+}
+
+/* Splits the capture into records, applies task descriptions and converts the
+ * wrapping timestamps into microseconds. */
+static void prvDecode(const uint8_t *pucData, size_t xSize)
+{
+	uint64_t ullNow = 0, ullSessionEnd = 0;
+	uint32_t ulLast = 0;
+	int iHaveTime = 0, iChar;
+	size_t xOffset = 0;
+
+	while (xOffset + schedTRACE_FRAME_SIZE <= xSize)
+	{
+		const uint8_t *pucFrame = pucData + xOffset;
+		SchedTraceRecord_t xRecord;
+		TraceEvent_t *pxEvent;
+
+		if (schedTRACE_SYNC_0 != pucFrame[0] || schedTRACE_SYNC_1 != pucFrame[1])
+		{
+			xOffset++;
+			xSkippedBytes++;
+			continue;
+		}
+
+		xRecord.ulTimestamp = (uint32_t)pucFrame[2] | ((uint32_t)pucFrame[3] << 8) | ((uint32_t)pucFrame[4] << 16) | ((uint32_t)pucFrame[5] << 24);
+		xRecord.ucEvent = pucFrame[6];
+		xRecord.ucTask = pucFrame[7];
+		xRecord.usArg = (uint16_t)(pucFrame[8] | (pucFrame[9] << 8));
+		if (!prvRecordIsValid(&xRecord))
+		{
+			xOffset++;
+			xSkippedBytes++;
+			continue;
+		}
+		xOffset += schedTRACE_FRAME_SIZE;
+
+		switch (xRecord.ucEvent)
+		{
+			case schedTRACE_START:
+				/* The target was reset. Its records continue after the last one
+				 * decoded so far, the timeline of the previous run ends there. */
+				ulTimeUnit = xRecord.usArg ? xRecord.usArg : 1;
+				iHaveTime = 0;
+				ullSessionEnd = ullNow;
+				if (0 != xEvents.xCount)
+				{
+					pxEvent = (TraceEvent_t *)prvArrayAdd(&xEvents, sizeof(TraceEvent_t));
+					pxEvent->ullTime = ullNow;
+					pxEvent->ucEvent = schedTRACE_START;
+					pxEvent->ucTask = schedTRACE_NO_TASK;
+					pxEvent->usArg = 0;
+				}
+				continue;
+
+			case schedTRACE_TICK_PERIOD:
+				ulTickPeriod = xRecord.usArg;
+				continue;
+
+			case schedTRACE_TASK_NAME:
+				if (0 == xRecord.usArg)
+				{
+					memset(xTasks[xRecord.ucTask].cName, 0, sizeof(xTasks[xRecord.ucTask].cName));
+				}
+				for (iChar = 0; iChar < 4 && xRecord.usArg + iChar < traceMAX_NAME_LEN; iChar++)
+				{
+					xTasks[xRecord.ucTask].cName[xRecord.usArg + iChar] = (char)(xRecord.ulTimestamp >> (8 * iChar));
+				}
+				xTasks[xRecord.ucTask].ucSeen = 1;
+				continue;
+
+			/* Descriptions are stamped when they are sent, not in record order. */
+			case schedTRACE_TASK_PERIOD:
+				xTasks[xRecord.ucTask].ulPeriod = xRecord.usArg;
+				continue;
+
+			case schedTRACE_TASK_DEADLINE:
+				xTasks[xRecord.ucTask].ulDeadline = xRecord.usArg;
+				continue;
+
+			case schedTRACE_DROPPED:
+				ulDroppedRecords += xRecord.usArg;
+				xRecord.ulTimestamp = ulLast;
+				break;
+
+			default:
+				break;
+		}
+
+		/* Records are stamped when they are added to the buffer, so their
+		 * timestamps only move forward apart from the 32 bit wrap. */
+		if (!iHaveTime)
+		{
+			ullNow = ullSessionEnd;
+			iHaveTime = 1;
+		}
+		else
+		{
+			ullNow += (uint64_t)(uint32_t)(xRecord.ulTimestamp - ulLast) * ulTimeUnit;
+		}
+		ulLast = xRecord.ulTimestamp;
+
+		pxEvent = (TraceEvent_t *)prvArrayAdd(&xEvents, sizeof(TraceEvent_t));
+		pxEvent->ullTime = ullNow;
+		pxEvent->ucEvent = xRecord.ucEvent;
+		pxEvent->ucTask = xRecord.ucTask;
+		pxEvent->usArg = xRecord.usArg;
+		if (schedTRACE_NO_TASK != xRecord.ucTask)
+		{
+			xTasks[xRecord.ucTask].ucSeen = 1;
+		}
+		if ((schedTRACE_RESOURCE_BLOCKED == xRecord.ucEvent || schedTRACE_RESOURCE_ACQUIRE == xRecord.ucEvent ||
+			 schedTRACE_RESOURCE_RELEASE == xRecord.ucEvent) && xRecord.usArg >= usResourceCount)
+		{
+			usResourceCount = (uint16_t)(xRecord.usArg + 1);
+		}
+	}
+
+	xSkippedBytes += xSize - xOffset;
+}
+
+static void prvAddSlice(uint8_t ucTask, uint8_t ucKind, uint64_t ullStart, uint64_t ullEnd, uint16_t usArg)
+{
+	TraceSlice_t *pxSlice = (TraceSlice_t *)prvArrayAdd(&xSlices, sizeof(TraceSlice_t));
+
+	pxSlice->ullStart = ullStart;
+	pxSlice->ullEnd = ullEnd;
+	pxSlice->ulJob = xTasks[ucTask].ulJobs;
+	pxSlice->ucTask = ucTask;
+	pxSlice->ucKind = ucKind;
+	pxSlice->usArg = usArg;
+}
+
+static void prvAddMark(uint8_t ucTask, uint8_t ucKind, uint64_t ullTime, uint16_t usArg)
+{
+	TraceMark_t *pxMark = (TraceMark_t *)prvArrayAdd(&xMarks, sizeof(TraceMark_t));
+
+	pxMark->ullTime = ullTime;
+	pxMark->ulJob = (schedTRACE_NO_TASK == ucTask) ? 0 : xTasks[ucTask].ulJobs;
+	pxMark->ucTask = ucTask;
+	pxMark->ucKind = ucKind;
+	pxMark->usArg = usArg;
+}
+
+/* Ends the resource slices of a task, for resources that are released without
+ * a release record (overrun or abort). */
+static void prvEndResources(uint8_t ucTask, uint64_t ullTime)
+{
+	TraceTask_t *pxTask = &xTasks[ucTask];
+
+	if (pxTask->ucBlocked)
+	{
+		prvAddSlice(ucTask, traceSLICE_BLOCK, pxTask->ullBlockStart, ullTime, pxTask->usBlockedOn);
+		pxTask->ucBlocked = 0;
+	}
+	while (pxTask->ucHeldCount > 0)
+	{
+		pxTask->ucHeldCount--;
+		prvAddSlice(ucTask, traceSLICE_HOLD, pxTask->ullHoldStart[pxTask->ucHeldCount], ullTime, pxTask->usHeld[pxTask->ucHeldCount]);
+	}
+}
+
+static void prvEndJob(uint8_t ucTask, uint64_t ullTime)
+{
+	TraceTask_t *pxTask = &xTasks[ucTask];
+
+	if (pxTask->ucInJob)
+	{
+		prvAddSlice(ucTask, traceSLICE_JOB, pxTask->ullJobStart, ullTime, 0);
+		pxTask->ucInJob = 0;
+	}
+}
+
+/* Ends all slices that are still open. */
+static void prvEndAll(uint64_t ullTime)
+{
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < traceMAX_TASKS; xIndex++)
+	{
+		TraceTask_t *pxTask = &xTasks[xIndex];
+
+		prvEndResources((uint8_t)xIndex, ullTime);
+		prvEndJob((uint8_t)xIndex, ullTime);
+		if (pxTask->ucRunning)
+		{
+			prvAddSlice((uint8_t)xIndex, traceSLICE_RUN, pxTask->ullRunStart, ullTime, 0);
+			pxTask->ucRunning = 0;
+		}
+	}
+}
+
+/* Rebuilds the slices and marks of every task from the decoded events. */
+static void prvBuildTimeline(void)
+{
+	const TraceEvent_t *pxEvents = (const TraceEvent_t *)xEvents.pvItems;
+	uint64_t ullEnd = 0;
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < xEvents.xCount; xIndex++)
+	{
+		const TraceEvent_t *pxEvent = &pxEvents[xIndex];
+		uint64_t ullTime = pxEvent->ullTime;
+		TraceTask_t *pxTask;
+
+		ullEnd = ullTime;
+		if (schedTRACE_START == pxEvent->ucEvent)
+		{
+			prvEndAll(ullTime);
+			continue;
+		}
+		if (schedTRACE_NO_TASK == pxEvent->ucTask)
+		{
+			prvAddMark(schedTRACE_NO_TASK, traceMARK_DROPPED, ullTime, pxEvent->usArg);
+			continue;
+		}
+		pxTask = &xTasks[pxEvent->ucTask];
+
+		switch (pxEvent->ucEvent)
+		{
+			case schedTRACE_JOB_RELEASE:
+			{
+				/* The job was released usArg ticks before it started. */
+				uint64_t ullDelay = (uint64_t)pxEvent->usArg * ulTickPeriod;
+				uint64_t ullRelease = (ullDelay <= ullTime) ? ullTime - ullDelay : 0;
+
+				if (pxTask->ucInJob && ullRelease < pxTask->ullJobStart)
+				{
+					ullRelease = ullTime;
+				}
+				prvEndJob(pxEvent->ucTask, ullRelease);
+				pxTask->ulJobs++;
+				pxTask->ucInJob = 1;
+				pxTask->ullJobStart = ullRelease;
+				prvAddMark(pxEvent->ucTask, traceMARK_RELEASE, ullRelease, 0);
+				if (0 != pxTask->ulDeadline)
+				{
+					prvAddMark(pxEvent->ucTask, traceMARK_DEADLINE, ullRelease + (uint64_t)pxTask->ulDeadline * ulTickPeriod, 0);
+				}
+				break;
+			}
+
+			case schedTRACE_JOB_COMPLETE:
+				if (pxTask->ucInJob)
+				{
+					if (ullTime - pxTask->ullJobStart > pxTask->ullMaxResponse)
+					{
+						pxTask->ullMaxResponse = ullTime - pxTask->ullJobStart;
+					}
+					pxTask->ulCompleted++;
+				}
+				prvEndJob(pxEvent->ucTask, ullTime);
+				break;
+
+			case schedTRACE_SWITCH_IN:
+				pxTask->ucRunning = 1;
+				pxTask->ucStopped = 0;
+				pxTask->ullRunStart = ullTime;
+				break;
+
+			case schedTRACE_SWITCH_OUT:
+				if (pxTask->ucRunning)
+				{
+					prvAddSlice(pxEvent->ucTask, traceSLICE_RUN, pxTask->ullRunStart, ullTime, 0);
+					pxTask->ucRunning = 0;
+				}
+				if (pxTask->ucInJob && !pxTask->ucBlocked && !pxTask->ucStopped)
+				{
+					pxTask->ulPreemptions++;
+					prvAddMark(pxEvent->ucTask, traceMARK_PREEMPT, ullTime, 0);
+				}
+				break;
+
+			case schedTRACE_RESOURCE_BLOCKED:
+				pxTask->ucBlocked = 1;
+				pxTask->usBlockedOn = pxEvent->usArg;
+				pxTask->ullBlockStart = ullTime;
+				break;
+
+			case schedTRACE_RESOURCE_ACQUIRE:
+				if (pxTask->ucBlocked)
+				{
+					prvAddSlice(pxEvent->ucTask, traceSLICE_BLOCK, pxTask->ullBlockStart, ullTime, pxTask->usBlockedOn);
+					pxTask->ucBlocked = 0;
+				}
+				if (pxTask->ucHeldCount < traceMAX_RESOURCES)
+				{
+					pxTask->usHeld[pxTask->ucHeldCount] = pxEvent->usArg;
+					pxTask->ullHoldStart[pxTask->ucHeldCount] = ullTime;
+					pxTask->ucHeldCount++;
+				}
+				break;
+
+			case schedTRACE_RESOURCE_RELEASE:
+			{
+				int iHeld;
+
+				for (iHeld = pxTask->ucHeldCount - 1; iHeld >= 0; iHeld--)
+				{
+					if (pxTask->usHeld[iHeld] == pxEvent->usArg)
+					{
+						prvAddSlice(pxEvent->ucTask, traceSLICE_HOLD, pxTask->ullHoldStart[iHeld], ullTime, pxEvent->usArg);
+						memmove(&pxTask->usHeld[iHeld], &pxTask->usHeld[iHeld + 1], (pxTask->ucHeldCount - iHeld - 1) * sizeof(pxTask->usHeld[0]));
+						memmove(&pxTask->ullHoldStart[iHeld], &pxTask->ullHoldStart[iHeld + 1], (pxTask->ucHeldCount - iHeld - 1) * sizeof(pxTask->ullHoldStart[0]));
+						pxTask->ucHeldCount--;
+						break;
+					}
+				}
+				break;
+			}
+
+			case schedTRACE_DEADLINE_MISS:
+				pxTask->ulMisses++;
+				prvAddMark(pxEvent->ucTask, traceMARK_MISS, ullTime, 0);
+				break;
+
+			case schedTRACE_EXEC_TIME_EXCEEDED:
+				/* The task is stopped until its next period and its resources
+				 * are released by the scheduler. */
+				pxTask->ulOverruns++;
+				pxTask->ucStopped = 1;
+				prvEndResources(pxEvent->ucTask, ullTime);
+				prvAddMark(pxEvent->ucTask, traceMARK_OVERRUN, ullTime, 0);
+				break;
+
+			case schedTRACE_PRIORITY:
+				prvAddMark(pxEvent->ucTask, traceMARK_PRIORITY, ullTime, pxEvent->usArg);
+				break;
+
+			case schedTRACE_TASK_RECREATED:
+				pxTask->ulAborts++;
+				prvEndResources(pxEvent->ucTask, ullTime);
+				prvEndJob(pxEvent->ucTask, ullTime);
+				if (pxTask->ucRunning)
+				{
+					prvAddSlice(pxEvent->ucTask, traceSLICE_RUN, pxTask->ullRunStart, ullTime, 0);
+					pxTask->ucRunning = 0;
+				}
+				prvAddMark(pxEvent->ucTask, traceMARK_ABORT, ullTime, 0);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	/* Slices still open at the end of the capture end with it. */
+	prvEndAll(ullEnd);
+}
+
+/* Writes cName as a JSON string. */
+static void prvWriteJSONString(FILE *pxOut, const char *pcText)
+{
+	fputc('"', pxOut);
+	for (; '\0' != *pcText; pcText++)
+	{
+		unsigned char ucChar = (unsigned char)*pcText;
+
+		if ('"' == ucChar || '\\' == ucChar)
+		{
+			fprintf(pxOut, "\\%c", ucChar);
+		}
+		else if (ucChar < 0x20 || ucChar >= 0x7F)
+		{
+			fprintf(pxOut, "\\u%04x", ucChar);
+		}
+		else
+		{
+			fputc(ucChar, pxOut);
+		}
+	}
+	fputc('"', pxOut);
+}
+
+static const char *prvTaskName(uint8_t ucTask, char *pcBuffer, size_t xSize)
+{
+	if ('\0' != xTasks[ucTask].cName[0])
+	{
+		return xTasks[ucTask].cName;
+	}
+	snprintf(pcBuffer, xSize, "task %u", ucTask);
+	return pcBuffer;
+}
+
+/* Chrome trace event format. Task slot n is process n + 1 with the threads
+ * 1 (running), 2 (jobs) and 3 (resources); process 0 holds system marks. */
+static void prvWriteJSON(FILE *pxOut)
+{
+	static const char *const pcMarkNames[] = { "release", "deadline", "preempted", "deadline miss", "exec time exceeded", "aborted", "priority", "dropped" };
+	static const char *const pcTrackNames[] = { "running", "jobs", "resources" };
+	const TraceSlice_t *pxSlices = (const TraceSlice_t *)xSlices.pvItems;
+	const TraceMark_t *pxMarks = (const TraceMark_t *)xMarks.pvItems;
+	char cBuffer[traceMAX_NAME_LEN + 8];
+	size_t xIndex;
+	int iTrack;
+
+	fprintf(pxOut, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(pxOut, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"scheduler\"}}");
+	for (xIndex = 0; xIndex < traceMAX_TASKS; xIndex++)
+	{
+		if (!xTasks[xIndex].ucSeen)
+		{
+			continue;
+		}
+		fprintf(pxOut, ",\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"name\":", (unsigned)xIndex + 1);
+		prvWriteJSONString(pxOut, prvTaskName((uint8_t)xIndex, cBuffer, sizeof(cBuffer)));
+		fprintf(pxOut, "}}");
+		fprintf(pxOut, ",\n{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":%u,\"args\":{\"sort_index\":%u}}", (unsigned)xIndex + 1, (unsigned)xIndex + 1);
+		for (iTrack = 0; iTrack < 3; iTrack++)
+		{
+			fprintf(pxOut, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%u,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", (unsigned)xIndex + 1, iTrack + 1,
+					pcTrackNames[iTrack]);
+		}
+	}
+
+	for (xIndex = 0; xIndex < xSlices.xCount; xIndex++)
+	{
+		const TraceSlice_t *pxSlice = &pxSlices[xIndex];
+		unsigned uPid = (unsigned)pxSlice->ucTask + 1;
+		unsigned long long ullStart = (unsigned long long)pxSlice->ullStart;
+		unsigned long long ullDuration = (unsigned long long)(pxSlice->ullEnd - pxSlice->ullStart);
+
+		switch (pxSlice->ucKind)
+		{
+			case traceSLICE_RUN:
+				fprintf(pxOut, ",\n{\"name\":\"job %u\",\"cat\":\"run\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":1}", pxSlice->ulJob, ullStart,
+						ullDuration, uPid);
+				break;
+			case traceSLICE_JOB:
+				fprintf(pxOut, ",\n{\"name\":\"job %u\",\"cat\":\"job\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":2,\"args\":{\"response_us\":%llu}}",
+						pxSlice->ulJob, ullStart, ullDuration, uPid, ullDuration);
+				break;
+			case traceSLICE_HOLD:
+				fprintf(pxOut, ",\n{\"name\":\"R%u\",\"cat\":\"resource\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":3}", pxSlice->usArg + 1, ullStart,
+						ullDuration, uPid);
+				break;
+			default:
+				fprintf(pxOut, ",\n{\"name\":\"blocked on R%u\",\"cat\":\"blocked\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":3}", pxSlice->usArg + 1,
+						ullStart, ullDuration, uPid);
+				break;
+		}
+	}
+
+	for (xIndex = 0; xIndex < xMarks.xCount; xIndex++)
+	{
+		const TraceMark_t *pxMark = &pxMarks[xIndex];
+		unsigned long long ullTime = (unsigned long long)pxMark->ullTime;
+
+		if (schedTRACE_NO_TASK == pxMark->ucTask)
+		{
+			fprintf(pxOut, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%llu,\"pid\":0,\"tid\":0,\"args\":{\"records\":%u}}", pcMarkNames[pxMark->ucKind],
+					ullTime, pxMark->usArg);
+		}
+		else if (traceMARK_PRIORITY == pxMark->ucKind)
+		{
+			fprintf(pxOut, ",\n{\"name\":\"priority\",\"ph\":\"C\",\"ts\":%llu,\"pid\":%u,\"args\":{\"priority\":%u}}", ullTime, (unsigned)pxMark->ucTask + 1,
+					pxMark->usArg);
+		}
+		else
+		{
+			fprintf(pxOut, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%llu,\"pid\":%u,\"tid\":2,\"args\":{\"job\":%u}}", pcMarkNames[pxMark->ucKind],
+					ullTime, (unsigned)pxMark->ucTask + 1, pxMark->ulJob);
+		}
+	}
+
+	fprintf(pxOut, "\n]}\n");
+}
+
+/* Value change of one VCD variable. */
+typedef struct xTraceChange
+{
+	uint64_t ullTime;
+	uint32_t ulSequence;	/* Keeps the order of changes at the same time. */
+	uint16_t usVariable;
+	uint16_t usValue;
+	uint8_t ucOrder;		/* Changes to 0 come first, so back to back slices stay high. */
+} TraceChange_t;
+
+/* Variables of a task, in the order they are declared. */
+#define traceVCD_RUNNING	0
+#define traceVCD_JOB		1
+#define traceVCD_BLOCKED	2
+#define traceVCD_PRIORITY	3
+#define traceVCD_MISS		4
+#define traceVCD_OVERRUN	5
+#define traceVCD_TASK_VARIABLES 6
+
+static TraceArray_t xChanges;
+
+static void prvAddChange(uint64_t ullTime, uint16_t usVariable, uint16_t usValue)
+{
+	TraceChange_t *pxChange = (TraceChange_t *)prvArrayAdd(&xChanges, sizeof(TraceChange_t));
+
+	pxChange->ullTime = ullTime;
+	pxChange->ulSequence = (uint32_t)xChanges.xCount;
+	pxChange->usVariable = usVariable;
+	pxChange->usValue = usValue;
+	pxChange->ucOrder = (0 == usValue) ? 0 : 1;
+}
+
+static int prvCompareChanges(const void *pvA, const void *pvB)
+{
+	const TraceChange_t *pxA = (const TraceChange_t *)pvA;
+	const TraceChange_t *pxB = (const TraceChange_t *)pvB;
+
+	if (pxA->ullTime != pxB->ullTime)
+	{
+		return (pxA->ullTime < pxB->ullTime) ? -1 : 1;
+	}
+	if (pxA->ucOrder != pxB->ucOrder)
+	{
+		return (int)pxA->ucOrder - (int)pxB->ucOrder;
+	}
+	return (pxA->ulSequence < pxB->ulSequence) ? -1 : (pxA->ulSequence > pxB->ulSequence);
+}
+
+/* Short printable identifier of variable usVariable. */
+static void prvVCDIdentifier(uint16_t usVariable, char *pcId)
+{
+	unsigned uValue = usVariable;
+
+	do
+	{
+		*pcId++ = (char)('!' + uValue % 94);
+		uValue /= 94;
+	} while (0 != uValue);
+	*pcId = '\0';
+}
+
+/* Whether variable usVariable is a vector (priority or resource holder) and
+ * not a single wire or event. */
+static int prvVCDIsVector(uint16_t usVariable, uint16_t usResourceBase)
+{
+	return usVariable >= usResourceBase || traceVCD_PRIORITY == usVariable % traceVCD_TASK_VARIABLES;
+}
+
+static int prvVCDIsEvent(uint16_t usVariable, uint16_t usResourceBase)
+{
+	uint16_t usKind = usVariable % traceVCD_TASK_VARIABLES;
+
+	return usVariable < usResourceBase && (traceVCD_MISS == usKind || traceVCD_OVERRUN == usKind);
+}
+
+static void prvVCDValue(FILE *pxOut, uint16_t usVariable, uint16_t usValue, uint16_t usResourceBase)
+{
+	char cId[4];
+	int iBit;
+
+	prvVCDIdentifier(usVariable, cId);
+	if (prvVCDIsEvent(usVariable, usResourceBase))
+	{
+		fprintf(pxOut, "1%s\n", cId);
+	}
+	else if (prvVCDIsVector(usVariable, usResourceBase))
+	{
+		fputc('b', pxOut);
+		for (iBit = 7; iBit > 0 && 0 == (usValue >> iBit); iBit--)
+		{
+		}
+		for (; iBit >= 0; iBit--)
+		{
+			fputc('0' + ((usValue >> iBit) & 1), pxOut);
+		}
+		fprintf(pxOut, " %s\n", cId);
+	}
+	else
+	{
+		fprintf(pxOut, "%u%s\n", usValue ? 1 : 0, cId);
+	}
+}
+
+/* Value change dump with a 1 us timescale. Every task has the wires running,
+ * job and blocked, its priority and the events deadline_miss and
+ * exec_time_exceeded. Every resource has the slot of its holder plus one, 0
+ * if it is free. */
+static void prvWriteVCD(FILE *pxOut)
+{
+	static const char *const pcVariableNames[] = { "running", "job", "blocked", "priority", "deadline_miss", "exec_time_exceeded" };
+	const TraceSlice_t *pxSlices = (const TraceSlice_t *)xSlices.pvItems;
+	const TraceMark_t *pxMarks = (const TraceMark_t *)xMarks.pvItems;
+	const uint16_t usResourceBase = traceMAX_TASKS * traceVCD_TASK_VARIABLES;
+	const TraceChange_t *pxChanges;
+	char cBuffer[traceMAX_NAME_LEN + 8], cId[4];
+	uint64_t ullLastTime = 0;
+	size_t xIndex;
+	int iVariable;
+
+	for (xIndex = 0; xIndex < xSlices.xCount; xIndex++)
+	{
+		const TraceSlice_t *pxSlice = &pxSlices[xIndex];
+		uint16_t usBase = (uint16_t)(pxSlice->ucTask * traceVCD_TASK_VARIABLES);
+
+		/* A slice of no length would leave its variable set. */
+		if (pxSlice->ullStart == pxSlice->ullEnd)
+		{
+			continue;
+		}
+		switch (pxSlice->ucKind)
+		{
+			case traceSLICE_RUN:
+				prvAddChange(pxSlice->ullStart, usBase + traceVCD_RUNNING, 1);
+				prvAddChange(pxSlice->ullEnd, usBase + traceVCD_RUNNING, 0);
+				break;
+			case traceSLICE_JOB:
+				prvAddChange(pxSlice->ullStart, usBase + traceVCD_JOB, 1);
+				prvAddChange(pxSlice->ullEnd, usBase + traceVCD_JOB, 0);
+				break;
+			case traceSLICE_BLOCK:
+				prvAddChange(pxSlice->ullStart, usBase + traceVCD_BLOCKED, 1);
+				prvAddChange(pxSlice->ullEnd, usBase + traceVCD_BLOCKED, 0);
+				break;
+			default:
+				prvAddChange(pxSlice->ullStart, (uint16_t)(usResourceBase + pxSlice->usArg), (uint16_t)(pxSlice->ucTask + 1));
+				prvAddChange(pxSlice->ullEnd, (uint16_t)(usResourceBase + pxSlice->usArg), 0);
+				break;
+		}
+	}
+	for (xIndex = 0; xIndex < xMarks.xCount; xIndex++)
+	{
+		const TraceMark_t *pxMark = &pxMarks[xIndex];
+		uint16_t usBase = (uint16_t)(pxMark->ucTask * traceVCD_TASK_VARIABLES);
+
+		if (schedTRACE_NO_TASK == pxMark->ucTask)
+		{
+			continue;
+		}
+		switch (pxMark->ucKind)
+		{
+			case traceMARK_PRIORITY:
+				prvAddChange(pxMark->ullTime, usBase + traceVCD_PRIORITY, pxMark->usArg);
+				break;
+			case traceMARK_MISS:
+				prvAddChange(pxMark->ullTime, usBase + traceVCD_MISS, 1);
+				break;
+			case traceMARK_OVERRUN:
+				prvAddChange(pxMark->ullTime, usBase + traceVCD_OVERRUN, 1);
+				break;
+			default:
+				break;
+		}
+	}
+	qsort(xChanges.pvItems, xChanges.xCount, sizeof(TraceChange_t), prvCompareChanges);
+
+	fprintf(pxOut, "$comment scheduler trace $end\n$timescale 1 us $end\n$scope module scheduler $end\n");
+	for (xIndex = 0; xIndex < traceMAX_TASKS; xIndex++)
+	{
+		char cModule[traceMAX_NAME_LEN + 8];
+		const char *pcName;
+		size_t xChar;
+
+		if (!xTasks[xIndex].ucSeen)
+		{
+			continue;
+		}
+		/* Module names cannot contain white space. */
+		pcName = prvTaskName((uint8_t)xIndex, cBuffer, sizeof(cBuffer));
+		for (xChar = 0; xChar < sizeof(cModule) - 1 && '\0' != pcName[xChar]; xChar++)
+		{
+			cModule[xChar] = (pcName[xChar] <= ' ' || pcName[xChar] >= 0x7F) ? '_' : pcName[xChar];
+		}
+		cModule[xChar] = '\0';
+		fprintf(pxOut, "$scope module %s $end\n", cModule);
+		for (iVariable = 0; iVariable < traceVCD_TASK_VARIABLES; iVariable++)
+		{
+			uint16_t usVariable = (uint16_t)(xIndex * traceVCD_TASK_VARIABLES + iVariable);
+
+			prvVCDIdentifier(usVariable, cId);
+			if (prvVCDIsEvent(usVariable, usResourceBase))
+			{
+				fprintf(pxOut, "$var event 1 %s %s $end\n", cId, pcVariableNames[iVariable]);
+			}
+			else
+			{
+				fprintf(pxOut, "$var %s %d %s %s $end\n", prvVCDIsVector(usVariable, usResourceBase) ? "reg" : "wire",
+						prvVCDIsVector(usVariable, usResourceBase) ? 8 : 1, cId, pcVariableNames[iVariable]);
+			}
+		}
+		fprintf(pxOut, "$upscope $end\n");
+	}
+	for (iVariable = 0; iVariable < usResourceCount; iVariable++)
+	{
+		prvVCDIdentifier((uint16_t)(usResourceBase + iVariable), cId);
+		fprintf(pxOut, "$var reg 8 %s R%d_holder $end\n", cId, iVariable + 1);
+	}
+	fprintf(pxOut, "$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+	for (xIndex = 0; xIndex < traceMAX_TASKS; xIndex++)
+	{
+		if (!xTasks[xIndex].ucSeen)
+		{
+			continue;
+		}
+		for (iVariable = 0; iVariable < traceVCD_TASK_VARIABLES; iVariable++)
+		{
+			uint16_t usVariable = (uint16_t)(xIndex * traceVCD_TASK_VARIABLES + iVariable);
+
+			if (!prvVCDIsEvent(usVariable, usResourceBase))
+			{
+				prvVCDValue(pxOut, usVariable, 0, usResourceBase);
+			}
+		}
+	}
+	for (iVariable = 0; iVariable < usResourceCount; iVariable++)
+	{
+		prvVCDValue(pxOut, (uint16_t)(usResourceBase + iVariable), 0, usResourceBase);
+	}
+	fprintf(pxOut, "$end\n");
+
+	pxChanges = (const TraceChange_t *)xChanges.pvItems;
+	for (xIndex = 0; xIndex < xChanges.xCount; xIndex++)
+	{
+		if (pxChanges[xIndex].ullTime != ullLastTime)
+		{
+			ullLastTime = pxChanges[xIndex].ullTime;
+			fprintf(pxOut, "#%llu\n", (unsigned long long)ullLastTime);
+		}
+		prvVCDValue(pxOut, pxChanges[xIndex].usVariable, pxChanges[xIndex].usValue, usResourceBase);
+	}
+}
+
+static void prvPrintSummary(void)
+{
+	char cBuffer[traceMAX_NAME_LEN + 8];
+	size_t xIndex;
+
+	fprintf(stderr, "%-16s %8s %8s %8s %8s %8s %8s %12s\n", "task", "period", "jobs", "misses", "overruns", "aborted", "preempt", "max resp us");
+	for (xIndex = 0; xIndex < traceMAX_TASKS; xIndex++)
+	{
+		const TraceTask_t *pxTask = &xTasks[xIndex];
+
+		if (!pxTask->ucSeen)
+		{
+			continue;
+		}
+		fprintf(stderr, "%-16s %8u %8u %8u %8u %8u %8u %12llu\n", prvTaskName((uint8_t)xIndex, cBuffer, sizeof(cBuffer)), pxTask->ulPeriod,
+				pxTask->ulCompleted, pxTask->ulMisses, pxTask->ulOverruns, pxTask->ulAborts, pxTask->ulPreemptions, (unsigned long long)pxTask->ullMaxResponse);
+	}
+	fprintf(stderr, "%zu records, %zu bytes skipped, %u records dropped on the target\n", xEvents.xCount, xSkippedBytes, ulDroppedRecords);
+}
+
+int main(int argc, char **argv)
+{
+	const char *pcFormat = "json", *pcOutput = NULL;
+	FILE *pxIn = stdin, *pxOut = stdout;
+	uint8_t *pucData;
+	size_t xSize;
+	int iOption;
+
+	while (-1 != (iOption = getopt(argc, argv, "f:o:")))
+	{
+		switch (iOption)
+		{
+			case 'f': pcFormat = optarg; break;
+			case 'o': pcOutput = optarg; break;
+			default:
+				fprintf(stderr, "usage: %s [-f json|vcd] [-o output] [capture]\n", argv[0]);
+				return 2;
+		}
+	}
+	if ((optind + 1 < argc) || (0 != strcmp(pcFormat, "json") && 0 != strcmp(pcFormat, "vcd")))
+	{
+		fprintf(stderr, "usage: %s [-f json|vcd] [-o output] [capture]\n", argv[0]);
+		return 2;
+	}
+
+	if (optind < argc && NULL == (pxIn = fopen(argv[optind], "rb")))
+	{
+		perror(argv[optind]);
+		return 1;
+	}
+	pucData = prvReadAll(pxIn, &xSize);
+	if (NULL == pucData)
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	if (stdin != pxIn)
+	{
+		fclose(pxIn);
+	}
+
+	prvDecode(pucData, xSize);
+	free(pucData);
+	prvBuildTimeline();
+
+	if (NULL != pcOutput && NULL == (pxOut = fopen(pcOutput, "w")))
+	{
+		perror(pcOutput);
+		return 1;
+	}
+	if (0 == strcmp(pcFormat, "vcd"))
+	{
+		prvWriteVCD(pxOut);
+	}
+	else
+	{
+		prvWriteJSON(pxOut);
+	}
+	if (stdout != pxOut)
+	{
+		fclose(pxOut);
+	}
+
+	prvPrintSummary();
+	return 0;
+}
@@ -0,0 +1,348 @@
+/* Stress test of scheduler.cpp across tick count wraps.
+ *
+ *   make check
+ *
+ * The scheduler is compiled into this program against the mock kernel, whose
+ * ticks are 16 bits wide as on the target. First schedTIME_BEFORE is checked
+ * for every start tick around the wrap. Then four periodic tasks are run under
+ * EDF from 1000 ticks before a wrap to 500 ticks after the fourth wrap, one
+ * tick at a time: the tick hook, the scheduler task pass, the releases and one
+ * tick of execution of the job in the running band, as on the target. A model
+ * in 64 bit time checks at every tick that the scheduler task is woken exactly
+ * when the earliest armed wake time has come, that the running job has the
+ * earliest absolute deadline and that a deadline miss is flagged exactly when
+ * a job is still unfinished after its deadline. The job of w2 whose window
+ * contains a wrap overruns, so each wrap sees a deadline miss. A released task
+ * hands its job to the dispatcher itself, and when it lowers its own priority
+ * the kernel switches tasks at once, so the dispatcher must be settled by
+ * then, see prvCheckYield. The budget timer interrupt must stop only a job
+ * that has used up its budget, see prvCheckBudgetTimer. */
+
+#include <stdio.h>
+
+#include "scheduler.cpp"
+
+#define wrapTASKS 4
+#define wrapCOUNT 4
+#define wrapSTART (0x10000ULL - 1000)
+
+typedef struct xWrapTask
+{
+	const char *pcName;
+	TickType_t xExecTime;
+	TickType_t xPeriod;
+	TickType_t xDeadline;
+	TickType_t xPhase;
+	BaseType_t xOverrunAtWrap;	/* A job whose window contains a wrap overruns. */
+	TaskHandle_t xHandle;
+	SchedTCB_t *pxTCB;
+
+	/* Model of the current job in 64 bit time. */
+	uint64_t ullRelease;
+	uint64_t ullDeadline;
+	TickType_t xRemaining;
+	BaseType_t xActive;
+	BaseType_t xMissed;
+	BaseType_t xOverrun;
+	BaseType_t xReleasedOnce;
+} WrapTask_t;
+
+/* w2 is released 5 ticks before every wrap, 35 + wrapSTART is 59 modulo 64. */
+static WrapTask_t xWrapTasks[wrapTASKS] = {
+	{"w0", 1, 10, 10, 0, pdFALSE},
+	{"w1", 2, 15, 12, 3, pdFALSE},
+	{"w2", 3, 64, 10, 35, pdTRUE},
+	{"w3", 5, 60, 60, 7, pdFALSE},
+};
+
+static unsigned long ulFailures = 0;
+static uint64_t ullNow = 0;
+
+static void prvWrapJob(void *pvParameters)
+{
+	(void)pvParameters;
+}
+
+static void prvFail(uint64_t ullTime, const char *pcWhat, const char *pcName)
+{
+	if (ulFailures++ < 20)
+	{
+		fprintf(stderr, "tick %llu (0x%04x): %s %s\n", (unsigned long long)ullTime, (unsigned)(TickType_t)ullTime, pcWhat, pcName);
+	}
+}
+
+/* Called by the mock kernel when the current task lowers its own priority.
+ * The task that runs next must see its job in the deadline heap, the earliest
+ * job in the running band and every other ready job parked. */
+static void prvCheckYield(TaskHandle_t xTask)
+{
+	SchedTCB_t *pxTCB = prvGetTCBFromHandle(xTask);
+	UBaseType_t uxIndex;
+
+	if (NULL == pxTCB)
+	{
+		prvFail(ullNow, "yield of an unknown task", "");
+		return;
+	}
+	if (schedEDF_NOT_IN_HEAP == pxTCB->uxEDFHeapIndex)
+	{
+		prvFail(ullNow, "yield before the job was dispatched:", pxTCB->pcName);
+		return;
+	}
+	if (NULL == pxEDFRunningTask || pxEDFHeap[0] != pxEDFRunningTask || schedEDF_RUNNING_PRIORITY != pxEDFRunningTask->uxPriority)
+	{
+		prvFail(ullNow, "yield before the running band was set:", pxTCB->pcName);
+		return;
+	}
+	for (uxIndex = 0; uxIndex < uxEDFHeapSize; uxIndex++)
+	{
+		if (pxEDFHeap[uxIndex] != pxEDFRunningTask && schedEDF_PARKED_PRIORITY != uxTaskPriorityGet(*pxEDFHeap[uxIndex]->pxTaskHandle))
+		{
+			prvFail(ullNow, "yield before the ready job was parked:", pxEDFHeap[uxIndex]->pcName);
+		}
+	}
+}
+
+#if (schedUSE_BUDGET_TIMER == 1)
+/* Raises the budget timer interrupt while pxTCB runs a job that has run for
+ * xRunTime of its budget of 1000 us. The mock kernel does not start the timer
+ * itself. */
+static BaseType_t prvBudgetTimerStops(SchedTCB_t *pxTCB, SchedExecTime_t xRunTime)
+{
+	SchedExecTime_t xMaxExecTime = pxTCB->xMaxExecTime;
+	BaseType_t xStopped;
+
+	pxTCB->xMaxExecTime = 1000;
+	pxTCB->xExecTime = 0;
+	pxTCB->xSwitchInTime = schedEXEC_TIME_NOW() - xRunTime;
+	pxTCB->xExecStart = pdTRUE;
+	pxCurrentSchedTCB = pxTCB;
+	prvBudgetTimerExpired();
+	xStopped = pxTCB->xMaxExecTimeExceeded;
+
+	pxCurrentSchedTCB = NULL;
+	pxTCB->xExecStart = pdFALSE;
+	pxTCB->xMaxExecTimeExceeded = pdFALSE;
+	pxTCB->xSuspended = pdFALSE;
+	pxTCB->xExecTime = 0;
+	pxTCB->xMaxExecTime = xMaxExecTime;
+	return xStopped;
+}
+
+/* A late interrupt that was raised for the budget of another job must leave
+ * the running job alone. */
+static void prvCheckBudgetTimer(SchedTCB_t *pxTCB)
+{
+	if (pdFALSE != prvBudgetTimerStops(pxTCB, 500))
+	{
+		prvFail(0, "budget timer stopped a job within its budget:", pxTCB->pcName);
+	}
+	if (pdFALSE == prvBudgetTimerStops(pxTCB, 2000))
+	{
+		prvFail(0, "budget timer did not stop a job over its budget:", pxTCB->pcName);
+	}
+}
+#endif /* schedUSE_BUDGET_TIMER */
+
+static void prvCheckTimeBefore(void)
+{
+	uint32_t ulBase, ulDistance;
+	TickType_t xA, xB;
+
+	for (ulBase = 0x10000 - 2048; ulBase < 0x10000 + 2048; ulBase++)
+	{
+		for (ulDistance = 1; ulDistance <= schedMAX_TICK_SPAN; ulDistance += (ulDistance < 256) ? 1 : 251)
+		{
+			xA = (TickType_t)ulBase;
+			xB = (TickType_t)(ulBase + ulDistance);
+			if (!schedTIME_BEFORE(xA, xB) || schedTIME_BEFORE(xB, xA) || schedTIME_BEFORE(xA, xA))
+			{
+				prvFail(ulBase, "schedTIME_BEFORE", "");
+			}
+		}
+		if (!schedTIME_BEFORE((TickType_t)ulBase, (TickType_t)(ulBase + schedMAX_TICK_SPAN)))
+		{
+			prvFail(ulBase, "schedTIME_BEFORE at schedMAX_TICK_SPAN", "");
+		}
+	}
+}
+
+int main(void)
+{
+	WrapTask_t *pxTask;
+	SchedTCB_t *pxRunning;
+	uint64_t ullTime, ullEarliest, ullArmed = 0;
+	BaseType_t xArmed = pdFALSE, xWoken, xIndex;
+	TickType_t xNow;
+	unsigned long ulJobs = 0, ulMisses = 0, ulOverruns = 0, ulWraps = 0;
+
+	prvCheckTimeBefore();
+
+	vSchedulerInit();
+	vMockSetYieldHook(prvCheckYield);
+	for (xIndex = 0; xIndex < wrapTASKS; xIndex++)
+	{
+		pxTask = &xWrapTasks[xIndex];
+		vSchedulerPeriodicTaskCreate(prvWrapJob, pxTask->pcName, configMINIMAL_STACK_SIZE, NULL, 0, &pxTask->xHandle, pxTask->xPhase,
+									 pxTask->xPeriod, pxTask->xExecTime, pxTask->xDeadline, NULL, 0, schedDEADLINE_MISS_CONTINUE, NULL);
+	}
+	xSystemStartTime = (TickType_t)wrapSTART;
+	prvCreateAllTasks();
+	for (xIndex = 0; xIndex < wrapTASKS; xIndex++)
+	{
+		pxTask = &xWrapTasks[xIndex];
+		pxTask->pxTCB = prvGetTCBFromHandle(pxTask->xHandle);
+		configASSERT(NULL != pxTask->pxTCB);
+		pxTask->ullRelease = wrapSTART + pxTask->xPhase;
+	}
+#if (schedUSE_BUDGET_TIMER == 1)
+	prvCheckBudgetTimer(xWrapTasks[0].pxTCB);
+#endif /* schedUSE_BUDGET_TIMER */
+
+	for (ullTime = wrapSTART; ullTime < wrapSTART + wrapCOUNT * 0x10000ULL + 500; ullTime++)
+	{
+		xNow = (TickType_t)ullTime;
+		ullNow = ullTime;
+		vMockSetTickCount(xNow);
+		if (0 == xNow)
+		{
+			ulWraps++;
+		}
+
+		/* The tick hook must wake the scheduler task at the earliest armed time. */
+		xWoken = xSchedulerWakeArmed;
+		vApplicationTickHook();
+		xWoken = (pdTRUE == xWoken && pdFALSE == xSchedulerWakeArmed) ? pdTRUE : pdFALSE;
+		if (xWoken != ((pdTRUE == xArmed && ullArmed <= ullTime) ? pdTRUE : pdFALSE))
+		{
+			prvFail(ullTime, xWoken ? "scheduler woken early" : "scheduler not woken", "");
+		}
+
+		/* Pass of the scheduler task, see prvSchedulerFunction. */
+		if (pdTRUE == xWoken)
+		{
+			xArmed = pdFALSE;
+			prvUpdateEDFPriorities(pdTRUE);
+			for (xIndex = 0; xIndex < wrapTASKS; xIndex++)
+			{
+				pxTask = &xWrapTasks[xIndex];
+				prvSchedulerCheckTimingError(xNow, pxTask->pxTCB);
+
+				if (pdTRUE == pxTask->xActive && pdFALSE == pxTask->xMissed && pxTask->ullDeadline < ullTime)
+				{
+					pxTask->xMissed = pdTRUE;
+					ulMisses++;
+				}
+				if (pdTRUE == pxTask->xActive && pdFALSE == pxTask->xMissed && (pdFALSE == xArmed || pxTask->ullDeadline + 1 < ullArmed))
+				{
+					ullArmed = pxTask->ullDeadline + 1;
+					xArmed = pdTRUE;
+				}
+				if (pdTRUE == pxTask->xActive && pxTask->pxTCB->xDeadlineMissed != pxTask->xMissed)
+				{
+					prvFail(ullTime, pxTask->xMissed ? "deadline miss not flagged for" : "false deadline miss of", pxTask->pcName);
+				}
+			}
+		}
+
+		/* Releases, see prvPeriodicJob. Releases passed during an overrun are
+		 * caught up at once. */
+		for (xIndex = 0; xIndex < wrapTASKS; xIndex++)
+		{
+			pxTask = &xWrapTasks[xIndex];
+			if (pdTRUE == pxTask->xActive || pxTask->ullRelease > ullTime)
+			{
+				continue;
+			}
+			pxTask->ullDeadline = pxTask->ullRelease + pxTask->xDeadline;
+			pxTask->xRemaining = pxTask->xExecTime;
+			pxTask->xOverrun = (pdTRUE == pxTask->xOverrunAtWrap && (pxTask->ullRelease >> 16) != (pxTask->ullDeadline >> 16)) ? pdTRUE : pdFALSE;
+			if (pdTRUE == pxTask->xOverrun)
+			{
+				pxTask->xRemaining += pxTask->xDeadline;
+				ulOverruns++;
+			}
+			pxTask->xActive = pdTRUE;
+			pxTask->xMissed = pdFALSE;
+			pxTask->xReleasedOnce = pdTRUE;
+			ulJobs++;
+
+			pxTask->pxTCB->xLastWakeTime = (TickType_t)pxTask->ullRelease;
+			pxTask->pxTCB->xWorkIsDone = pdFALSE;
+			pxTask->pxTCB->xExecutedOnce = pdTRUE;
+			pxTask->pxTCB->xAbsoluteDeadline = pxTask->pxTCB->xLastWakeTime + pxTask->pxTCB->xRelativeDeadline;
+			vMockSetCurrentTask(pxTask->xHandle);
+			prvEDFJobReady(pxTask->pxTCB);
+			vMockSetCurrentTask(NULL);
+			prvSchedulerWakeAt(pxTask->pxTCB->xLastWakeTime + pxTask->pxTCB->xRelativeDeadline + 1);
+			if (pdFALSE == xArmed || pxTask->ullDeadline + 1 < ullArmed)
+			{
+				ullArmed = pxTask->ullDeadline + 1;
+				xArmed = pdTRUE;
+			}
+		}
+
+		/* The job in the running band must have the earliest deadline, every
+		 * other ready job is parked and every other task waits for its release. */
+		pxRunning = pxEDFRunningTask;
+		ullEarliest = UINT64_MAX;
+		for (xIndex = 0; xIndex < wrapTASKS; xIndex++)
+		{
+			pxTask = &xWrapTasks[xIndex];
+			if (pdTRUE == pxTask->xActive && pxTask->ullDeadline < ullEarliest)
+			{
+				ullEarliest = pxTask->ullDeadline;
+			}
+		}
+		for (xIndex = 0; xIndex < wrapTASKS; xIndex++)
+		{
+			pxTask = &xWrapTasks[xIndex];
+			if (pxTask->pxTCB == pxRunning)
+			{
+				if (pdFALSE == pxTask->xActive || pxTask->ullDeadline != ullEarliest)
+				{
+					prvFail(ullTime, "not the earliest deadline:", pxTask->pcName);
+				}
+				if (schedEDF_RUNNING_PRIORITY != uxTaskPriorityGet(pxTask->xHandle))
+				{
+					prvFail(ullTime, "not in the running band:", pxTask->pcName);
+				}
+			}
+			else if (pdTRUE == pxTask->xActive && schedEDF_PARKED_PRIORITY != uxTaskPriorityGet(pxTask->xHandle))
+			{
+				prvFail(ullTime, "ready job not parked:", pxTask->pcName);
+			}
+			else if (pdFALSE == pxTask->xActive && pdTRUE == pxTask->xReleasedOnce && schedEDF_RELEASE_PRIORITY != uxTaskPriorityGet(pxTask->xHandle))
+			{
+				prvFail(ullTime, "waiting task not in the release band:", pxTask->pcName);
+			}
+		}
+		if (NULL == pxRunning && UINT64_MAX != ullEarliest)
+		{
+			prvFail(ullTime, "no job dispatched", "");
+		}
+
+		/* One tick of execution. */
+		for (xIndex = 0; xIndex < wrapTASKS && NULL != pxRunning; xIndex++)
+		{
+			pxTask = &xWrapTasks[xIndex];
+			if (pxTask->pxTCB != pxRunning || 0 != --pxTask->xRemaining)
+			{
+				continue;
+			}
+			if (pdTRUE == pxTask->xOverrun && pdFALSE == pxTask->xMissed)
+			{
+				prvFail(ullTime, "overrun not detected for", pxTask->pcName);
+			}
+			pxTask->xActive = pdFALSE;
+			pxTask->ullRelease += pxTask->xPeriod;
+			pxRunning->xWorkIsDone = pdTRUE;
+			pxRunning->xDeadlineMissed = pdFALSE;
+			prvEDFJobNotReady(pxRunning, schedEDF_RELEASE_PRIORITY);
+		}
+	}
+
+	printf("%lu wraps, %lu jobs, %lu overruns, %lu deadline misses, %lu failures\n", ulWraps, ulJobs, ulOverruns, ulMisses, ulFailures);
+
+	return (0 == ulFailures && wrapCOUNT == ulWraps && ulOverruns == wrapCOUNT && ulMisses >= ulOverruns) ? 0 : 1;
+}
@@ -157,10 +157,10 @@ int main(void) {
 
   vSchedulerInit();
 
-  vSchedulerPeriodicTaskCreate(testFunc1, "t1", configMINIMAL_STACK_SIZE, &c1, 1, &xHandle1, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t1), pdMS_TO_TICKS(c1), pdMS_TO_TICKS(d1), NULL);
-  vSchedulerPeriodicTaskCreate(testFunc2, "t2", configMINIMAL_STACK_SIZE, &c2, 2, &xHandle2, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t2), pdMS_TO_TICKS(c2), pdMS_TO_TICKS(d2), NULL);
-  vSchedulerPeriodicTaskCreate(testFunc3, "t3", configMINIMAL_STACK_SIZE, &c3, 3, &xHandle3, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t3), pdMS_TO_TICKS(c3), pdMS_TO_TICKS(d3), NULL);
-  vSchedulerPeriodicTaskCreate(testFunc4, "t4", configMINIMAL_STACK_SIZE, &c4, 4, &xHandle4, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t4), pdMS_TO_TICKS(c4), pdMS_TO_TICKS(d4), NULL);
+  vSchedulerPeriodicTaskCreate(testFunc1, "t1", configMINIMAL_STACK_SIZE, &c1, 1, &xHandle1, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t1), pdMS_TO_TICKS(c1), pdMS_TO_TICKS(d1), NULL, 0, schedDEADLINE_MISS_ABORT, NULL);
+  vSchedulerPeriodicTaskCreate(testFunc2, "t2", configMINIMAL_STACK_SIZE, &c2, 2, &xHandle2, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t2), pdMS_TO_TICKS(c2), pdMS_TO_TICKS(d2), NULL, 0, schedDEADLINE_MISS_ABORT, NULL);
+  vSchedulerPeriodicTaskCreate(testFunc3, "t3", configMINIMAL_STACK_SIZE, &c3, 3, &xHandle3, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t3), pdMS_TO_TICKS(c3), pdMS_TO_TICKS(d3), NULL, 0, schedDEADLINE_MISS_ABORT, NULL);
+  vSchedulerPeriodicTaskCreate(testFunc4, "t4", configMINIMAL_STACK_SIZE, &c4, 4, &xHandle4, pdMS_TO_TICKS(0), pdMS_TO_TICKS(t4), pdMS_TO_TICKS(c4), pdMS_TO_TICKS(d4), NULL, 0, schedDEADLINE_MISS_ABORT, NULL);
 
   vSchedulerStart();
 
@@ -0,0 +1,533 @@
+#include "schedanalysis.h"
+
+size_t xSchedAnalysisAddResource(SchedAnalysisTask_t *pxTask, size_t xResource, uint32_t ulCriticalSection)
+{
+	if (0 == ulCriticalSection)
+	{
+		return 1;
+	}
+	if (schedANALYSIS_MAX_TASK_RESOURCES == pxTask->xResourceUseCount)
+	{
+		return 0;
+	}
+
+	pxTask->xResourceUse[pxTask->xResourceUseCount].usResource = (uint16_t)xResource;
+	pxTask->xResourceUse[pxTask->xResourceUseCount].ulCriticalSection = ulCriticalSection;
+	pxTask->xResourceUseCount++;
+
+	return 1;
+}
+
+/* Returns the blocking term of task xIndex for the given resource ceilings. */
+static uint32_t prvBlocking(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xIndex, const uint32_t *pulCeiling)
+{
+	uint32_t ulBlocking = 0;
+	size_t xOther, xUse;
+	const SchedAnalysisResourceUse_t *pxUse;
+
+	/* A task is blocked at most once, by the longest critical section of a
+	 * lower priority task on a resource that can block it. */
+	for (xOther = 0; xOther < xTaskCount; xOther++)
+	{
+		if (pxTasks[xOther].ulPriority >= pxTasks[xIndex].ulPriority)
+		{
+			continue;
+		}
+		for (xUse = 0; xUse < pxTasks[xOther].xResourceUseCount; xUse++)
+		{
+			pxUse = &pxTasks[xOther].xResourceUse[xUse];
+			if (pulCeiling[pxUse->usResource] >= pxTasks[xIndex].ulPriority && pxUse->ulCriticalSection > ulBlocking)
+			{
+				ulBlocking = pxUse->ulCriticalSection;
+			}
+		}
+	}
+
+	return ulBlocking;
+}
+
+/* Stores the ceilings of all resources in pulCeiling, the highest priority of
+ * the tasks using each one, in a single pass over the resources of the tasks. */
+static void prvResourceCeilings(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount, uint32_t *pulCeiling)
+{
+	size_t xIndex, xUse;
+	uint32_t *pulResourceCeiling;
+
+	for (xIndex = 0; xIndex < xResourceCount; xIndex++)
+	{
+		pulCeiling[xIndex] = 0;
+	}
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		for (xUse = 0; xUse < pxTasks[xIndex].xResourceUseCount; xUse++)
+		{
+			pulResourceCeiling = &pulCeiling[pxTasks[xIndex].xResourceUse[xUse].usResource];
+			if (pxTasks[xIndex].ulPriority > *pulResourceCeiling)
+			{
+				*pulResourceCeiling = pxTasks[xIndex].ulPriority;
+			}
+		}
+	}
+}
+
+void vSchedAnalysisSetBlocking(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount)
+{
+	uint32_t ulCeiling[schedANALYSIS_MAX_RESOURCES];
+	size_t xIndex;
+
+	prvResourceCeilings(pxTasks, xTaskCount, xResourceCount, ulCeiling);
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTasks[xIndex].ulBlocking = prvBlocking(pxTasks, xTaskCount, xIndex, ulCeiling);
+	}
+}
+
+void vSchedAnalysisSetPIPBlocking(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount)
+{
+	uint32_t ulCeiling[schedANALYSIS_MAX_RESOURCES];
+	uint32_t ulLongest[schedANALYSIS_MAX_RESOURCES];
+	uint32_t ulByTask, ulByResource, ulTaskLongest;
+	size_t xIndex, xOther, xUse, xResource;
+	const SchedAnalysisResourceUse_t *pxUse;
+
+	prvResourceCeilings(pxTasks, xTaskCount, xResourceCount, ulCeiling);
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		for (xResource = 0; xResource < xResourceCount; xResource++)
+		{
+			ulLongest[xResource] = 0;
+		}
+
+		/* Every lower priority task can block once, with its longest critical
+		 * section on a resource that can block this task. */
+		ulByTask = 0;
+		for (xOther = 0; xOther < xTaskCount; xOther++)
+		{
+			if (pxTasks[xOther].ulPriority >= pxTasks[xIndex].ulPriority)
+			{
+				continue;
+			}
+
+			ulTaskLongest = 0;
+			for (xUse = 0; xUse < pxTasks[xOther].xResourceUseCount; xUse++)
+			{
+				pxUse = &pxTasks[xOther].xResourceUse[xUse];
+				if (ulCeiling[pxUse->usResource] < pxTasks[xIndex].ulPriority)
+				{
+					continue;
+				}
+				if (pxUse->ulCriticalSection > ulTaskLongest)
+				{
+					ulTaskLongest = pxUse->ulCriticalSection;
+				}
+				if (pxUse->ulCriticalSection > ulLongest[pxUse->usResource])
+				{
+					ulLongest[pxUse->usResource] = pxUse->ulCriticalSection;
+				}
+			}
+			ulByTask += ulTaskLongest;
+		}
+
+		/* Every such resource can block once, for its longest critical section
+		 * in a lower priority task. */
+		ulByResource = 0;
+		for (xResource = 0; xResource < xResourceCount; xResource++)
+		{
+			ulByResource += ulLongest[xResource];
+		}
+
+		pxTasks[xIndex].ulBlocking = (ulByTask < ulByResource) ? ulByTask : ulByResource;
+	}
+}
+
+uint32_t ulSchedAnalysisResponseTime(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xIndex)
+{
+	return ulSchedAnalysisResponseTimeFrom(pxTasks, xTaskCount, xIndex, 0);
+}
+
+uint32_t ulSchedAnalysisResponseTimeFrom(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xIndex, uint32_t ulStart)
+{
+	const SchedAnalysisTask_t *pxTask = &pxTasks[xIndex];
+	uint32_t ulResponse, ulNext;
+	size_t xOther;
+
+	/* Start from the critical instant where every higher priority task is released once. */
+	ulNext = pxTask->ulExecTime + pxTask->ulBlocking;
+	for (xOther = 0; xOther < xTaskCount; xOther++)
+	{
+		if (xOther != xIndex && pxTasks[xOther].ulPriority >= pxTask->ulPriority)
+		{
+			ulNext += pxTasks[xOther].ulExecTime;
+		}
+	}
+	if (ulStart > ulNext)
+	{
+		ulNext = ulStart;
+	}
+
+	/* R = C + B + sum of ceil(R / Tj) * Cj, iterated until it is stable or too late. */
+	do
+	{
+		ulResponse = ulNext;
+		if (ulResponse > pxTask->ulDeadline)
+		{
+			return schedANALYSIS_UNSCHEDULABLE;
+		}
+
+		ulNext = pxTask->ulExecTime + pxTask->ulBlocking;
+		for (xOther = 0; xOther < xTaskCount; xOther++)
+		{
+			if (xOther != xIndex && pxTasks[xOther].ulPriority >= pxTask->ulPriority)
+			{
+				ulNext += ((ulResponse + pxTasks[xOther].ulPeriod - 1) / pxTasks[xOther].ulPeriod) * pxTasks[xOther].ulExecTime;
+			}
+		}
+	} while (ulNext != ulResponse);
+
+	return ulResponse;
+}
+
+/* Computes the response times of all tasks from their blocking terms. Returns
+ * the number of tasks that can miss their deadline. */
+static size_t prvResponseTimes(SchedAnalysisTask_t *pxTasks, size_t xTaskCount)
+{
+	size_t xIndex, xMisses = 0;
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTasks[xIndex].ulResponseTime = ulSchedAnalysisResponseTime(pxTasks, xTaskCount, xIndex);
+		if (schedANALYSIS_UNSCHEDULABLE == pxTasks[xIndex].ulResponseTime)
+		{
+			xMisses++;
+		}
+	}
+
+	return xMisses;
+}
+
+size_t xSchedAnalysisFixedPriority(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount)
+{
+	vSchedAnalysisSetBlocking(pxTasks, xTaskCount, xResourceCount);
+
+	return prvResponseTimes(pxTasks, xTaskCount);
+}
+
+size_t xSchedAnalysisFixedPriorityPIP(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount)
+{
+	vSchedAnalysisSetPIPBlocking(pxTasks, xTaskCount, xResourceCount);
+
+	return prvResponseTimes(pxTasks, xTaskCount);
+}
+
+size_t xSchedAnalysisFixedPriorityAdmit(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount, size_t xNewIndex)
+{
+	uint32_t ulCeiling[schedANALYSIS_MAX_RESOURCES];
+	uint32_t ulPreviousBlocking;
+	size_t xIndex, xMisses = 0;
+	SchedAnalysisTask_t *pxTask;
+
+	prvResourceCeilings(pxTasks, xTaskCount, xResourceCount, ulCeiling);
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTask = &pxTasks[xIndex];
+		ulPreviousBlocking = pxTask->ulBlocking;
+		pxTask->ulBlocking = prvBlocking(pxTasks, xTaskCount, xIndex, ulCeiling);
+
+		if (xIndex == xNewIndex || schedANALYSIS_UNSCHEDULABLE == pxTask->ulResponseTime)
+		{
+			pxTask->ulResponseTime = ulSchedAnalysisResponseTime(pxTasks, xTaskCount, xIndex);
+		}
+		else if (pxTask->ulPriority > pxTasks[xNewIndex].ulPriority && pxTask->ulBlocking == ulPreviousBlocking)
+		{
+			/* The new task neither preempts nor blocks this task any longer, so
+			 * the cached response time still holds. */
+		}
+		else
+		{
+			/* Response times only grow when a task is added, so the iteration
+			 * can go on from the cached value. */
+			pxTask->ulResponseTime = ulSchedAnalysisResponseTimeFrom(pxTasks, xTaskCount, xIndex, pxTask->ulResponseTime);
+		}
+
+		if (schedANALYSIS_UNSCHEDULABLE == pxTask->ulResponseTime)
+		{
+			xMisses++;
+		}
+	}
+
+	return xMisses;
+}
+
+size_t xSchedAnalysisAudsley(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount)
+{
+	uint32_t ulCeiling[schedANALYSIS_MAX_RESOURCES];
+	uint32_t ulLevel;
+	size_t xIndex, xCandidate, xUnassigned = xTaskCount;
+	SchedAnalysisTask_t *pxTask;
+
+	/* Unassigned tasks are above every assigned level. */
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTasks[xIndex].ulPriority = schedANALYSIS_UNASSIGNED;
+	}
+
+	/* Fill the levels from the lowest up. A task fits at a level if it meets
+	 * its deadline while every other unassigned task is above it; its response
+	 * time does not depend on how those are ordered among themselves. */
+	for (ulLevel = 1; ulLevel <= xTaskCount; ulLevel++)
+	{
+		xCandidate = xTaskCount;
+
+		for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+		{
+			pxTask = &pxTasks[xIndex];
+			if (schedANALYSIS_UNASSIGNED != pxTask->ulPriority)
+			{
+				continue;
+			}
+
+			/* Try tasks with long deadlines first, they are the likely fit. */
+			if (xCandidate != xTaskCount && pxTask->ulDeadline <= pxTasks[xCandidate].ulDeadline)
+			{
+				continue;
+			}
+
+			pxTask->ulPriority = ulLevel;
+			prvResourceCeilings(pxTasks, xTaskCount, xResourceCount, ulCeiling);
+			pxTask->ulBlocking = prvBlocking(pxTasks, xTaskCount, xIndex, ulCeiling);
+			pxTask->ulResponseTime = ulSchedAnalysisResponseTime(pxTasks, xTaskCount, xIndex);
+			pxTask->ulPriority = schedANALYSIS_UNASSIGNED;
+
+			if (schedANALYSIS_UNSCHEDULABLE != pxTask->ulResponseTime)
+			{
+				xCandidate = xIndex;
+			}
+		}
+
+		if (xCandidate == xTaskCount)
+		{
+			break;
+		}
+		pxTasks[xCandidate].ulPriority = ulLevel;
+		xUnassigned--;
+	}
+
+	/* Without a feasible order the remaining tasks take the top levels in
+	 * deadline monotonic order. */
+	for (; ulLevel <= xTaskCount; ulLevel++)
+	{
+		xCandidate = xTaskCount;
+		for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+		{
+			if (schedANALYSIS_UNASSIGNED == pxTasks[xIndex].ulPriority && (xCandidate == xTaskCount || pxTasks[xIndex].ulDeadline > pxTasks[xCandidate].ulDeadline))
+			{
+				xCandidate = xIndex;
+			}
+		}
+		pxTasks[xCandidate].ulPriority = ulLevel;
+	}
+
+	return xUnassigned;
+}
+
+void vSchedAnalysisSetEDFBlocking(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount)
+{
+	uint32_t ulCeiling[schedANALYSIS_MAX_RESOURCES];
+	size_t xIndex, xOther, xUse;
+	SchedAnalysisTask_t *pxTask;
+	const SchedAnalysisResourceUse_t *pxUse;
+
+	/* The ceiling of a resource is the shortest relative deadline of the tasks
+	 * using it. */
+	for (xIndex = 0; xIndex < xResourceCount; xIndex++)
+	{
+		ulCeiling[xIndex] = schedANALYSIS_UNSCHEDULABLE;
+	}
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		for (xUse = 0; xUse < pxTasks[xIndex].xResourceUseCount; xUse++)
+		{
+			pxUse = &pxTasks[xIndex].xResourceUse[xUse];
+			if (pxTasks[xIndex].ulDeadline < ulCeiling[pxUse->usResource])
+			{
+				ulCeiling[pxUse->usResource] = pxTasks[xIndex].ulDeadline;
+			}
+		}
+	}
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTask = &pxTasks[xIndex];
+		pxTask->ulBlocking = 0;
+
+		/* Only resources whose ceiling is at least the level of this task,
+		 * held by a task with a longer deadline, can block it. */
+		for (xOther = 0; xOther < xTaskCount; xOther++)
+		{
+			if (pxTasks[xOther].ulDeadline <= pxTask->ulDeadline)
+			{
+				continue;
+			}
+			for (xUse = 0; xUse < pxTasks[xOther].xResourceUseCount; xUse++)
+			{
+				pxUse = &pxTasks[xOther].xResourceUse[xUse];
+				if (ulCeiling[pxUse->usResource] <= pxTask->ulDeadline && pxUse->ulCriticalSection > pxTask->ulBlocking)
+				{
+					pxTask->ulBlocking = pxUse->ulCriticalSection;
+				}
+			}
+		}
+	}
+}
+
+/* Returns the processor demand of all jobs released and due in an interval of length ulTime. */
+static uint32_t prvDemand(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, uint32_t ulTime)
+{
+	uint32_t ulDemand = 0;
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		if (pxTasks[xIndex].ulDeadline <= ulTime)
+		{
+			ulDemand += ((ulTime - pxTasks[xIndex].ulDeadline) / pxTasks[xIndex].ulPeriod + 1) * pxTasks[xIndex].ulExecTime;
+		}
+	}
+
+	return ulDemand;
+}
+
+/* Returns the latest absolute deadline strictly before ulTime, or 0 if there is none. */
+static uint32_t prvLastDeadlineBefore(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, uint32_t ulTime)
+{
+	uint32_t ulLatest = 0, ulDeadline;
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		if (pxTasks[xIndex].ulDeadline < ulTime)
+		{
+			ulDeadline = ((ulTime - pxTasks[xIndex].ulDeadline - 1) / pxTasks[xIndex].ulPeriod) * pxTasks[xIndex].ulPeriod + pxTasks[xIndex].ulDeadline;
+			if (ulDeadline > ulLatest)
+			{
+				ulLatest = ulDeadline;
+			}
+		}
+	}
+
+	return ulLatest;
+}
+
+/* Returns the length of the synchronous busy period that starts with a
+ * blocking of ulBlocking, or 0 if it is longer than schedANALYSIS_MAX_BUSY_PERIOD.
+ * The iteration starts at ulStart, which must not exceed the result. */
+static uint32_t prvBusyPeriod(const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, uint32_t ulBlocking, uint32_t ulStart)
+{
+	uint32_t ulLength = 0, ulNext = ulBlocking;
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		ulNext += pxTasks[xIndex].ulExecTime;
+	}
+	if (ulStart > ulNext)
+	{
+		ulNext = ulStart;
+	}
+
+	while (ulNext != ulLength)
+	{
+		ulLength = ulNext;
+		if (ulLength > schedANALYSIS_MAX_BUSY_PERIOD)
+		{
+			return 0;
+		}
+
+		ulNext = ulBlocking;
+		for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+		{
+			ulNext += ((ulLength + pxTasks[xIndex].ulPeriod - 1) / pxTasks[xIndex].ulPeriod) * pxTasks[xIndex].ulExecTime;
+		}
+	}
+
+	return ulLength;
+}
+
+uint32_t ulSchedAnalysisEDF(SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount, uint32_t *pulBusyPeriod)
+{
+	uint32_t ulBusyPeriod, ulBlocking = 0, ulMinDeadline = schedANALYSIS_UNSCHEDULABLE;
+	uint32_t ulTime, ulDemand;
+	size_t xIndex;
+
+	vSchedAnalysisSetEDFBlocking(pxTasks, xTaskCount, xResourceCount);
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTasks[xIndex].ulResponseTime = schedANALYSIS_UNSCHEDULABLE;
+
+		/* A job that does not fit into its own deadline fails at once. This also
+		 * keeps every product in prvDemand and prvBusyPeriod within 32 bits. */
+		if (pxTasks[xIndex].ulDeadline == 0 || pxTasks[xIndex].ulExecTime + pxTasks[xIndex].ulBlocking > pxTasks[xIndex].ulDeadline)
+		{
+			return (pxTasks[xIndex].ulDeadline > 0) ? pxTasks[xIndex].ulDeadline : 1;
+		}
+		if (pxTasks[xIndex].ulBlocking > ulBlocking)
+		{
+			ulBlocking = pxTasks[xIndex].ulBlocking;
+		}
+		if (pxTasks[xIndex].ulDeadline < ulMinDeadline)
+		{
+			ulMinDeadline = pxTasks[xIndex].ulDeadline;
+		}
+	}
+
+	if (0 == xTaskCount)
+	{
+		return 0;
+	}
+
+	ulBusyPeriod = prvBusyPeriod(pxTasks, xTaskCount, ulBlocking, (NULL != pulBusyPeriod) ? *pulBusyPeriod : 0);
+	if (0 == ulBusyPeriod)
+	{
+		return schedANALYSIS_MAX_BUSY_PERIOD;
+	}
+	if (NULL != pulBusyPeriod)
+	{
+		*pulBusyPeriod = ulBusyPeriod;
+	}
+
+	/* QPA: walk backwards from the last deadline in the busy period. Where the
+	 * demand is below the interval length, no deadline between the demand and
+	 * the interval length can fail, so the search jumps straight to the demand. */
+	ulTime = prvLastDeadlineBefore(pxTasks, xTaskCount, ulBusyPeriod + 1);
+	ulDemand = prvDemand(pxTasks, xTaskCount, ulTime) + ulBlocking;
+
+	while (ulDemand <= ulTime && ulDemand > ulMinDeadline)
+	{
+		if (ulDemand < ulTime)
+		{
+			ulTime = ulDemand;
+		}
+		else
+		{
+			ulTime = prvLastDeadlineBefore(pxTasks, xTaskCount, ulTime);
+		}
+		ulDemand = prvDemand(pxTasks, xTaskCount, ulTime) + ulBlocking;
+	}
+
+	if (ulDemand > ulMinDeadline)
+	{
+		return ulTime;
+	}
+
+	for (xIndex = 0; xIndex < xTaskCount; xIndex++)
+	{
+		pxTasks[xIndex].ulResponseTime = pxTasks[xIndex].ulDeadline;
+	}
+
+	return 0;
+}
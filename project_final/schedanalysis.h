@@ -0,0 +1,142 @@
+#ifndef SCHEDANALYSIS_H_
+#define SCHEDANALYSIS_H_
+
+/* Offline schedulability analysis of periodic task sets. The module does not
+ * depend on FreeRTOS and uses integer arithmetic only, so the same code runs
+ * on the target at vSchedulerStart and on the host over many task sets.
+ * All times are given in the same unit, usually software ticks. */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of shared resources, the length of the ceiling tables. Must
+ * be at least schedMAX_NUMBER_OF_SHARED_RESOURCES when used by the scheduler. */
+#ifndef schedANALYSIS_MAX_RESOURCES
+	#define schedANALYSIS_MAX_RESOURCES 4
+#endif /* schedANALYSIS_MAX_RESOURCES */
+
+/* Maximum number of shared resources a single task can use. Must be at least
+ * schedMAX_RESOURCES_PER_TASK when used by the scheduler. */
+#ifndef schedANALYSIS_MAX_TASK_RESOURCES
+	#define schedANALYSIS_MAX_TASK_RESOURCES 4
+#endif /* schedANALYSIS_MAX_TASK_RESOURCES */
+
+/* Response time reported for a task that cannot meet its deadline. */
+#define schedANALYSIS_UNSCHEDULABLE 0xFFFFFFFFUL
+
+/* Use of one shared resource by a task. */
+typedef struct xSchedAnalysisResourceUse
+{
+	uint16_t usResource;		/* Index of the resource, below the resource count of the analysis. */
+	uint32_t ulCriticalSection;	/* Longest time the task holds the resource. */
+} SchedAnalysisResourceUse_t;
+
+/* Description of one periodic task. Deadlines must not exceed periods. */
+typedef struct xSchedAnalysisTask
+{
+	uint32_t ulPeriod;		/* Minimum time between two releases. */
+	uint32_t ulDeadline;	/* Relative deadline. */
+	uint32_t ulExecTime;	/* Worst-case execution time. */
+	uint32_t ulPriority;	/* Fixed priority, a larger value is a higher priority. */
+	SchedAnalysisResourceUse_t xResourceUse[ schedANALYSIS_MAX_TASK_RESOURCES ]; /* Resources the task uses, see xSchedAnalysisAddResource. */
+	size_t xResourceUseCount;	/* Number of entries in xResourceUse. */
+
+	/* Results. */
+	uint32_t ulBlocking;		/* Worst-case blocking by lower priority tasks. */
+	uint32_t ulResponseTime;	/* Worst-case response time, or schedANALYSIS_UNSCHEDULABLE. */
+} SchedAnalysisTask_t;
+
+/* Adds resource xResource, held for at most ulCriticalSection, to the resources
+ * used by the task. Nothing is added if ulCriticalSection is 0. Returns 0 if the
+ * task already uses schedANALYSIS_MAX_TASK_RESOURCES resources, 1 otherwise. */
+size_t xSchedAnalysisAddResource( SchedAnalysisTask_t *pxTask, size_t xResource, uint32_t ulCriticalSection );
+
+/* Computes the blocking term of every task under the priority ceiling
+ * protocol (OPCP or IPCP, both block a task at most once for the longest
+ * critical section of a lower priority task on a resource whose ceiling is
+ * at least the priority of the task). */
+void vSchedAnalysisSetBlocking( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount );
+
+/* Computes the blocking term of every task under the priority inheritance
+ * protocol. A task can be blocked once by every lower priority task and once
+ * on every resource that a task of its priority or higher also uses; the
+ * smaller of the two sums, each over the longest critical sections involved,
+ * is the blocking term. Only the resources the tasks list are covered. */
+void vSchedAnalysisSetPIPBlocking( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount );
+
+/* Returns the worst-case response time of task xIndex under fixed priority
+ * preemptive scheduling, using the blocking term stored in the task. Tasks of
+ * equal priority are counted as interfering. Returns schedANALYSIS_UNSCHEDULABLE
+ * if the response time exceeds the deadline. */
+uint32_t ulSchedAnalysisResponseTime( const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xIndex );
+
+/* Like ulSchedAnalysisResponseTime, but the iteration starts at ulStart, which
+ * must not exceed the response time, for example the response time of the
+ * task before another task was added to the set. */
+uint32_t ulSchedAnalysisResponseTimeFrom( const SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xIndex, uint32_t ulStart );
+
+/* Computes blocking terms and response times of all tasks under fixed
+ * priority scheduling with the priority ceiling protocol. Returns the number of
+ * tasks that can miss their deadline, 0 if the task set is schedulable. */
+size_t xSchedAnalysisFixedPriority( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount );
+
+/* Like xSchedAnalysisFixedPriority, with blocking terms of the priority
+ * inheritance protocol. */
+size_t xSchedAnalysisFixedPriorityPIP( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount );
+
+/* Admission test for task xNewIndex, added to a set that was analysed before.
+ * The other tasks must hold the blocking terms and response times of the last
+ * analysis, which stay valid if the priority order of the old tasks did not
+ * change. Tasks that the new task neither preempts nor blocks keep their
+ * response time, the others continue the iteration from it. Returns the number
+ * of tasks that can miss their deadline, as xSchedAnalysisFixedPriority. */
+size_t xSchedAnalysisFixedPriorityAdmit( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount, size_t xNewIndex );
+
+/* Priority of a task that Audsley's algorithm has not placed yet. */
+#define schedANALYSIS_UNASSIGNED 0xFFFFFFFFUL
+
+/* Audsley's optimal priority assignment, driven by the response time test with
+ * priority ceiling blocking. Finds an order in which every task meets its
+ * deadline whenever such an order exists. Sets ulPriority of the tasks to
+ * 1 .. xTaskCount, xTaskCount being the highest. Returns the number of tasks
+ * that could not be placed, 0 on success; those take the highest levels in
+ * deadline monotonic order. Blocking terms and response times are those found
+ * while placing the tasks. */
+size_t xSchedAnalysisAudsley( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount );
+
+/* Longest synchronous busy period examined by the EDF test. Task sets with a
+ * longer busy period, including every set with a utilization above 1, are
+ * reported as not schedulable. */
+#ifndef schedANALYSIS_MAX_BUSY_PERIOD
+	#define schedANALYSIS_MAX_BUSY_PERIOD 0x00FFFFFFUL
+#endif /* schedANALYSIS_MAX_BUSY_PERIOD */
+
+/* Computes the blocking term of every task under EDF with preemption levels
+ * ordered by relative deadline (stack resource policy). A task is blocked at
+ * most once, by the longest critical section of a task with a longer relative
+ * deadline on a resource that is also used by a task whose relative deadline
+ * is not longer than its own. */
+void vSchedAnalysisSetEDFBlocking( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount );
+
+/* Processor demand test for EDF with constrained deadlines, using Quick
+ * Processor-demand Analysis (QPA) over the synchronous busy period. The
+ * largest blocking term is added to the demand at every checked point, which
+ * keeps the demand monotonic as QPA requires. Sets the blocking term of every
+ * task and, for a schedulable set, its relative deadline as response time
+ * bound. Returns 0 if the task set is schedulable, otherwise the length of an
+ * interval whose demand exceeds it.
+ *
+ * pulBusyPeriod: If not NULL, holds the busy period of a subset of the tasks,
+ * for example before a task was added, or 0. The busy period search starts from
+ * it, and the busy period of the set is stored back. */
+uint32_t ulSchedAnalysisEDF( SchedAnalysisTask_t *pxTasks, size_t xTaskCount, size_t xResourceCount, uint32_t *pulBusyPeriod );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SCHEDANALYSIS_H_ */
@@ -0,0 +1,48 @@
+#ifndef SCHEDTRACE_H_
+#define SCHEDTRACE_H_
+
+/* Binary event trace of the periodic task scheduler. Events are recorded into
+ * a ring buffer and sent by a low priority task, see schedUSE_TRACE. The
+ * format does not depend on FreeRTOS, so host tools can decode the stream. */
+
+#include <stdint.h>
+
+/* Every record is sent as a frame of two sync bytes followed by the record,
+ * multi-byte fields in little endian order. Text printed on the same serial
+ * port between frames is skipped by the decoder. */
+#define schedTRACE_SYNC_0		0xA5
+#define schedTRACE_SYNC_1		0x5A
+#define schedTRACE_RECORD_SIZE	8
+#define schedTRACE_FRAME_SIZE	( 2 + schedTRACE_RECORD_SIZE )
+
+/* ucTask of records that do not belong to a periodic task. */
+#define schedTRACE_NO_TASK		0xFF
+
+/* Events. ucTask is the slot of the periodic task in the scheduler. */
+#define schedTRACE_START				1	/* Drain task started. usArg: unit of ulTimestamp in microseconds. */
+#define schedTRACE_TICK_PERIOD			2	/* usArg: software tick period in microseconds. */
+#define schedTRACE_TASK_NAME			3	/* ulTimestamp: four characters of the name starting at offset usArg. */
+#define schedTRACE_TASK_PERIOD			4	/* usArg: period in ticks. */
+#define schedTRACE_TASK_DEADLINE		5	/* usArg: relative deadline in ticks. */
+#define schedTRACE_JOB_RELEASE			6	/* A job starts its task code. usArg: ticks since its release. */
+#define schedTRACE_JOB_COMPLETE			7	/* The job finished its task code. */
+#define schedTRACE_SWITCH_IN			8	/* The task starts running. */
+#define schedTRACE_SWITCH_OUT			9	/* The task stops running. */
+#define schedTRACE_DEADLINE_MISS		10	/* The job passed its deadline. */
+#define schedTRACE_EXEC_TIME_EXCEEDED	11	/* The job exceeded its worst-case execution time. */
+#define schedTRACE_RESOURCE_BLOCKED		12	/* usArg: resource the task waits for. */
+#define schedTRACE_RESOURCE_ACQUIRE		13	/* usArg: resource. */
+#define schedTRACE_RESOURCE_RELEASE		14	/* usArg: resource. */
+#define schedTRACE_PRIORITY				15	/* usArg: priority assigned to the task. */
+#define schedTRACE_TASK_RECREATED		16	/* The task was recreated after an aborted job. */
+#define schedTRACE_DROPPED				17	/* usArg: records lost right before this one because the buffer was full. ulTimestamp: when the first was lost. */
+
+typedef struct xSchedTraceRecord
+{
+	uint32_t ulTimestamp;	/* Run time counter or tick count, see schedTRACE_START. */
+	uint8_t ucEvent;		/* One of the events above. */
+	uint8_t ucTask;			/* Task slot or schedTRACE_NO_TASK. */
+	uint16_t usArg;			/* Event argument. */
+} SchedTraceRecord_t;
+
+#endif /* SCHEDTRACE_H_ */
@@ -1,34 +1,166 @@
 #include "scheduler.h"
+#if (schedUSE_SCHEDULABILITY_TEST == 1 || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+#include "schedanalysis.h"
+#endif /* schedUSE_SCHEDULABILITY_TEST || schedSCHEDULING_POLICY */
+
+#if (schedUSE_HIGH_RESOLUTION_EXEC_TIME == 1)
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#else
+#include <time.h>
+#if (schedUSE_BUDGET_TIMER == 1)
+#include <signal.h>
+#endif /* schedUSE_BUDGET_TIMER */
+#endif /* __AVR__ */
+#endif /* schedUSE_HIGH_RESOLUTION_EXEC_TIME */
+
+#if (schedUSE_TRACE == 1)
+#include "schedtrace.h"
+#endif /* schedUSE_TRACE */
 
 #define schedUSE_TCB_ARRAY 1
 
+/* Policies that assign a fixed priority to every task in vSchedulerStart. */
+#define schedUSE_FIXED_PRIORITIES ((schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS) || (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DM) || (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA))
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1 && schedANALYSIS_MAX_RESOURCES < schedMAX_NUMBER_OF_SHARED_RESOURCES)
+#error schedANALYSIS_MAX_RESOURCES must be at least schedMAX_NUMBER_OF_SHARED_RESOURCES
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1 && schedANALYSIS_MAX_TASK_RESOURCES < schedMAX_RESOURCES_PER_TASK)
+#error schedANALYSIS_MAX_TASK_RESOURCES must be at least schedMAX_RESOURCES_PER_TASK
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
+#if (schedUSE_STATIC_ALLOCATION == 1 && configSUPPORT_STATIC_ALLOCATION != 1)
+#error schedUSE_STATIC_ALLOCATION needs configSUPPORT_STATIC_ALLOCATION in FreeRTOSConfig.h
+#endif /* schedUSE_STATIC_ALLOCATION */
+
+#if (schedUSE_STATIC_TASK_POOL == 1 && schedSTATIC_TASK_POOL_SIZE > schedMAX_NUMBER_OF_PERIODIC_TASKS)
+#error schedSTATIC_TASK_POOL_SIZE must be at most schedMAX_NUMBER_OF_PERIODIC_TASKS
+#endif /* schedUSE_STATIC_TASK_POOL */
+
+#if (schedUSE_SHARED_STACK == 1 && schedSUB_SCHEDULING_POLICY != schedSUB_SCHEDULING_POLICY_SRP)
+#error schedUSE_SHARED_STACK needs schedSUB_SCHEDULING_POLICY_SRP
+#endif /* schedUSE_SHARED_STACK */
+
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP && !(schedUSE_FIXED_PRIORITIES))
+#error schedSUB_SCHEDULING_POLICY_PIP needs RMS, DM or OPA
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+/* Every ready job but one is parked at the same priority, so priority ceilings
+ * cannot order them and blocking is not bounded by the EDF test. */
+#if (schedUSE_EDF_PRIORITY_BANDS == 1 && (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP || schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
+#error schedSUB_SCHEDULING_POLICY_OPCP and _IPCP need fixed priorities, use SRP with schedUSE_EDF_PRIORITY_BANDS
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+#if (schedUSE_EDF_PRIORITY_BANDS == 1 && configUSE_TIMERS == 1)
+/* The running job would otherwise share its priority with the timer task and
+ * the kernel would time slice between them. configTIMER_TASK_PRIORITY holds a
+ * cast, so the preprocessor cannot compare it. */
+static_assert(schedEDF_RUNNING_PRIORITY > configTIMER_TASK_PRIORITY, "schedEDF_RUNNING_PRIORITY must be above configTIMER_TASK_PRIORITY");
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+
+/* Execution times and budgets. With schedUSE_HIGH_RESOLUTION_EXEC_TIME they
+ * are kept in microseconds, read from the run time stats counter, otherwise in
+ * software ticks. */
+#if (schedUSE_HIGH_RESOLUTION_EXEC_TIME == 1)
+#if (configGENERATE_RUN_TIME_STATS != 1)
+#error schedUSE_HIGH_RESOLUTION_EXEC_TIME needs configGENERATE_RUN_TIME_STATS and the scheduler run time counter in FreeRTOSConfig.h
+#endif /* configGENERATE_RUN_TIME_STATS */
+typedef uint32_t SchedExecTime_t;
+#define schedEXEC_TIME_NOW() (ulSchedulerGetRunTimeCounter() * schedRUN_TIME_COUNTER_PERIOD_US)
+#define schedTICKS_TO_EXEC_TIME(xTicks) ((SchedExecTime_t)(xTicks) * portTICK_PERIOD_MS * 1000UL)
+#else
+typedef TickType_t SchedExecTime_t;
+#define schedEXEC_TIME_NOW() xTaskGetTickCountFromISR()
+#define schedTICKS_TO_EXEC_TIME(xTicks) ((SchedExecTime_t)(xTicks))
+#endif /* schedUSE_HIGH_RESOLUTION_EXEC_TIME */
+
+#if (schedUSE_BUDGET_TIMER == 1)
+#if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME != 1)
+#error schedUSE_BUDGET_TIMER needs schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME
+#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+#if defined(__AVR__)
+/* The AVR port switches context from an interrupt with taskYIELD, as its
+ * demos do. */
+#define schedYIELD_FROM_ISR(xSwitchRequired) \
+	if (pdFALSE != (xSwitchRequired))        \
+	{                                        \
+		taskYIELD();                         \
+	}
+#else
+#define schedYIELD_FROM_ISR(xSwitchRequired) portYIELD_FROM_ISR(xSwitchRequired)
+#endif /* __AVR__ */
+#endif /* schedUSE_BUDGET_TIMER */
+
+#if (schedUSE_SHARED_STACK == 1)
+/* Level Control Block. Periodic tasks with the same relative deadline run
+ * their jobs one after another on the worker task of their level. */
+typedef struct xExtended_LCB
+{
+	TickType_t xRelativeDeadline; /* Relative deadline of the tasks at this level. */
+	UBaseType_t uxTaskCount;	  /* Number of periodic tasks at this level, 0 if the level is free. */
+	TaskHandle_t xWorkerHandle;	  /* Worker task that runs the jobs, NULL if it is not created. */
+#if (schedUSE_STATIC_ALLOCATION == 1)
+	StaticTask_t xWorkerBuffer;
+	StackType_t uxWorkerStack[schedSHARED_STACK_SIZE];
+#endif /* schedUSE_STATIC_ALLOCATION */
+} SchedLCB_t;
+#endif /* schedUSE_SHARED_STACK */
+
 /* Extended Task control block for managing periodic tasks within this library. */
 typedef struct xExtended_TCB
 {
 	TaskFunction_t pvTaskCode;	  /* Function pointer to the code that will be run periodically. */
+	TaskFunction_t pvDegradedTaskCode; /* Job function used after a miss with schedDEADLINE_MISS_DEGRADE. */
 	const char *pcName;			  /* Name of the task. */
 	UBaseType_t uxStackDepth;	  /* Stack size of the task. */
 	void *pvParameters;			  /* Parameters to the task function. */
 	UBaseType_t uxPriority;		  /* Priority of the task. */
 	UBaseType_t uxBasePriority;	  /* Base Priority of the task. */
 	TaskHandle_t *pxTaskHandle;	  /* Task handle for the task. */
-	TickType_t xReleaseTime;	  /* Release time of the task. */
+	TickType_t xReleaseTime;	  /* Time from xLastWakeTime to the next release when the task (re)starts. */
 	TickType_t xRelativeDeadline; /* Relative deadline of the task. */
 	TickType_t xAbsoluteDeadline; /* Absolute deadline of the task. */
 	TickType_t xPeriod;			  /* Task period. */
 	TickType_t xLastWakeTime;	  /* Last time stamp when the task was running. */
-	TickType_t xMaxExecTime;	  /* Worst-case execution time of the task. */
-	TickType_t xExecTime;		  /* Current execution time of the task. */
+	SchedExecTime_t xMaxExecTime;  /* Worst-case execution time of the task. */
+	SchedExecTime_t xExecTime;	   /* Execution time of the current job up to the last switch out. */
+	SchedExecTime_t xSwitchInTime; /* Time stamp when the task was last switched in. */
+	TickType_t xMaxExecTimeTick;   /* Worst-case execution time in software ticks, used by the schedulability test. */
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+	TickType_t xResponseTime; /* Worst-case response time found by the schedulability test. */
+	TickType_t xBlockingTime; /* Blocking term found by the schedulability test. */
+#endif /* schedUSE_SCHEDULABILITY_TEST */
 
 	BaseType_t xWorkIsDone; /* pdFALSE if the job is not finished, pdTRUE if the job is finished. */
+	BaseType_t xDeletePending; /* pdTRUE if the task deleted itself and waits for the scheduler task to remove it. */
 
 #if (schedUSE_TCB_ARRAY == 1)
 	BaseType_t xPriorityIsSet; /* pdTRUE if the priority is assigned. */
 	BaseType_t xInUse;		   /* pdFALSE if this extended TCB is empty. */
 #endif
 
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	UBaseType_t uxEDFHeapIndex; /* Position of this TCB in pxEDFHeap. */
+#endif /* schedSCHEDULING_POLICY */
+
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	BaseType_t xJobStarted; /* pdTRUE once the job was dispatched, it then runs regardless of the system ceiling. */
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+#if (schedUSE_SHARED_STACK == 1)
+	SchedLCB_t *pxLevel; /* Level whose worker runs the jobs of the task. */
+#elif (schedUSE_STATIC_ALLOCATION == 1)
+	StackType_t *puxStackBuffer; /* Stack of the task, uxStackDepth words. */
+	StaticTask_t *pxTaskBuffer;	 /* Memory for the kernel TCB of the task. */
+#endif							 /* schedUSE_SHARED_STACK */
+
 #if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
 	BaseType_t xExecutedOnce; /* pdTRUE if the task has executed once. */
+	BaseType_t xMissPolicy;	  /* Reaction to a missed deadline, one of schedDEADLINE_MISS_*. */
+	BaseType_t xDeadlineMissed; /* pdTRUE if the current job missed its deadline and runs late. */
+	BaseType_t xDegraded;	  /* pdTRUE while jobs run pvDegradedTaskCode. */
 #endif						  /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 
 #if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1 || schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
@@ -43,22 +175,40 @@ typedef struct xExtended_TCB
 	/* add if you need anything else */
 	BaseType_t xExecStart;
 	BaseType_t xBlocked;
-	BaseType_t xResourceIndex;
-	BaseType_t xResourceAccessed;
-	TickType_t xRTickArray[schedMAX_NUMBER_OF_SHARED_RESOURCES];
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP || schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+	BaseType_t xBlockedResource; /* Resource the task waits for while xBlocked is pdTRUE. */
+#endif /* schedSUB_SCHEDULING_POLICY */
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+	TickType_t xBlockedSince;	 /* Time the task started to wait for xBlockedResource. */
+	TickType_t xJobBlockingTime; /* Time the current job has waited for resources. */
+	TickType_t xMaxBlockingTime; /* Longest xJobBlockingTime measured so far. */
+#endif /* schedSUB_SCHEDULING_POLICY */
+	UBaseType_t uxHeldCount;								 /* Number of resources the task holds. */
+	BaseType_t xHeldResource[schedMAX_RESOURCES_PER_TASK]; /* Held resources in the order they were taken, the innermost last. */
+	UBaseType_t uxResourceUseCount;							 /* Number of resources the task uses. */
+	SchedResourceUse_t xResourceUse[schedMAX_RESOURCES_PER_TASK]; /* Resources the task uses and how long it holds them. */
 } SchedTCB_t;
 
 /* Resource Control Block to manage resource sharing */
 typedef struct xExtended_RCB
 {
 	BaseType_t priorityCeiling;
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	TickType_t xPreemptionCeiling; /* Shortest relative deadline of the tasks using the resource, portMAX_DELAY if unused. */
+#endif /* schedSUB_SCHEDULING_POLICY */
 	BaseType_t xInUse;
 	SemaphoreHandle_t xMutexSem;
 	TaskHandle_t xMutexHolder;
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+	struct xExtended_RCB *pxNextInUse; /* Next resource in use with the same priority ceiling. */
+#endif /* schedSUB_SCHEDULING_POLICY */
+#if (schedUSE_STATIC_ALLOCATION == 1)
+	StaticSemaphore_t xMutexBuffer;
+#endif /* schedUSE_STATIC_ALLOCATION */
 } SchedRCB_t;
 
 #if (schedUSE_TCB_ARRAY == 1)
-static BaseType_t prvGetTCBIndexFromHandle(TaskHandle_t xTaskHandle);
+static SchedTCB_t *prvGetTCBFromHandle(TaskHandle_t xTaskHandle);
 static void prvInitTCBArray(void);
 /* Find index for an empty entry in xTCBArray. Return -1 if there is no empty entry. */
 static BaseType_t prvFindEmptyElementIndexTCB(void);
@@ -67,26 +217,123 @@ static void prvDeleteTCBFromArray(BaseType_t xIndex);
 #endif /* schedUSE_TCB_ARRAY */
 
 static void prvInitRCBArray(void);
+static void prvPushHeldResource(SchedTCB_t *pxTCB, BaseType_t xResourceIndex);
+static void prvPopHeldResource(SchedTCB_t *pxTCB, BaseType_t xResourceIndex);
+#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP))
+static UBaseType_t prvHeldPriority(SchedTCB_t *pxTCB);
+#endif /* schedSUB_SCHEDULING_POLICY */
 
 static TickType_t xSystemStartTime = 0;
+/* pdTRUE once vSchedulerStart has created the periodic tasks. Tasks created
+ * after that go through admission control. */
+static BaseType_t xSchedulerRunning = pdFALSE;
+
+/* Tick values are compared modulo the TickType_t range, so the scheduler keeps
+ * working when the tick count wraps around (every 65536 ticks with
+ * configUSE_16_BIT_TICKS). Compared times must be less than half the range
+ * apart, which vSchedulerPeriodicTaskCreate checks for periods and deadlines. */
+#if (configUSE_16_BIT_TICKS == 1)
+typedef int16_t SchedSignedTick_t;
+#else
+typedef int32_t SchedSignedTick_t;
+#endif /* configUSE_16_BIT_TICKS */
 
+#define schedMAX_TICK_SPAN ((TickType_t)(((TickType_t)~(TickType_t)0) >> 1))
+
+/* pdTRUE if tick xA comes before tick xB. */
+#define schedTIME_BEFORE(xA, xB) ((SchedSignedTick_t)((TickType_t)(xA) - (TickType_t)(xB)) < 0)
+
+static void prvPeriodicJob(SchedTCB_t *pxThisTask);
+#if (schedUSE_SHARED_STACK == 1)
+static SchedLCB_t *prvFindLevel(TickType_t xRelativeDeadline);
+static SchedTCB_t *prvLevelNextRelease(SchedLCB_t *pxLevel, TickType_t *pxRelease);
+static void prvLevelWorkerCode(void *pvParameters);
+static BaseType_t prvCreateLevelWorker(SchedLCB_t *pxLevel);
+#else
 static void prvPeriodicTaskCode(void *pvParameters);
+#endif /* schedUSE_SHARED_STACK */
+static SchedTCB_t *prvPeriodicTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
+										 TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, const SchedResourceUse_t *pxResourceUse,
+										 UBaseType_t uxResourceUseCount, BaseType_t xMissPolicy, TaskFunction_t pvDegradedTaskCode);
+static BaseType_t prvCreateKernelTask(SchedTCB_t *pxTCB);
 static void prvCreateAllTasks(void);
+static BaseType_t prvAdmitTask(SchedTCB_t *pxNewTCB);
+static void prvPeriodicTaskRemove(SchedTCB_t *pxTCB);
+
+#if (schedUSE_FIXED_PRIORITIES)
+static BaseType_t prvSetFixedPriorities(void);
+static void prvPrintFixedPriorities(BaseType_t xFeasible);
+#endif /* schedSCHEDULING_POLICY */
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+static BaseType_t prvCheckSchedulability(SchedTCB_t *pxNewTCB);
+static void prvPrintSchedulability(SchedTCB_t *pxNewTCB, BaseType_t xSchedulable);
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+#if (schedUSE_SCHEDULABILITY_TEST == 1 || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+static size_t prvGetAnalysisTasks(SchedAnalysisTask_t *pxTasks, SchedTCB_t **ppxSlot);
+#endif /* schedUSE_SCHEDULABILITY_TEST || schedSCHEDULING_POLICY */
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+static BaseType_t prvSetOPARanks(TickType_t *pxRank);
+#endif /* schedSCHEDULING_POLICY */
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+/* Highest priority a periodic task can get under EDF. */
+#if (schedUSE_SCHEDULER_TASK == 1)
+#define schedEDF_HIGHEST_TASK_PRIORITY (schedSCHEDULER_PRIORITY - 1)
+#else
+#define schedEDF_HIGHEST_TASK_PRIORITY (configMAX_PRIORITIES - 1)
+#endif /* schedUSE_SCHEDULER_TASK */
 
-#if ((schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS) || (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DM))
-static void prvSetFixedPriorities(void);
+/* Number of tasks that get a distinct priority level, the rest share priority 0. */
+#define schedEDF_RANKED_TASKS schedEDF_HIGHEST_TASK_PRIORITY
+
+/* uxEDFHeapIndex of a TCB that is not in pxEDFHeap. */
+#define schedEDF_NOT_IN_HEAP ((UBaseType_t)~(UBaseType_t)0)
+
+static BaseType_t prvEDFDeadlineBefore(SchedTCB_t *pxA, SchedTCB_t *pxB);
+static void prvEDFHeapInsert(SchedTCB_t *pxTCB);
+static void prvEDFHeapRemove(SchedTCB_t *pxTCB);
+static void prvEDFDeadlineChanged(SchedTCB_t *pxTCB);
+static void prvEDFSetPriority(SchedTCB_t *pxTCB, UBaseType_t uxPriority, BaseType_t xApplyToTask);
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+static void prvEDFJobReady(SchedTCB_t *pxTCB);
+static void prvEDFJobNotReady(SchedTCB_t *pxTCB, UBaseType_t uxPriority);
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+static void prvSetEDFInitialPriorities(void);
+static void prvUpdateEDFPriorities(BaseType_t xApplyToTasks);
 #endif /* schedSCHEDULING_POLICY */
 
 #if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
+static void prvComputePriorityCeilings(void);
+#if (schedUSE_FIXED_PRIORITIES)
+static void prvPrintPriorityCeilings(void);
 static void prvSetPriorityCeilings(void);
+#endif /* schedSCHEDULING_POLICY */
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+#if (schedSCHEDULING_POLICY != schedSCHEDULING_POLICY_EDF || schedUSE_EDF_PRIORITY_BANDS != 1)
+#error schedSUB_SCHEDULING_POLICY_SRP needs EDF with schedUSE_EDF_PRIORITY_BANDS
+#endif /* schedSCHEDULING_POLICY */
+static void prvSetPreemptionCeilings(void);
+static void prvSRPUpdateSystemCeiling(void);
+static SchedTCB_t *prvSRPEarliestEligible(void);
 #endif /* schedSUB_SCHEDULING_POLICY */
 
 #if (schedUSE_SCHEDULER_TASK == 1)
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
 static void prvSchedulerCheckTimingError(TickType_t xTickCount, SchedTCB_t *pxTCB);
-static void prvSchedulerFunction(void);
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+static void prvSchedulerFunction(void *pvParameters);
 static void prvCreateSchedulerTask(void);
 static void prvWakeScheduler(void);
 
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1 && (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1))
+static void prvSchedulerWakeAt(TickType_t xWakeTime);
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER && (schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME) */
+
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
+static void prvReleaseHeldResources(SchedTCB_t *pxTCB);
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+
 #if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
 static void prvPeriodicTaskRecreate(SchedTCB_t *pxTCB);
 static void prvDeadlineMissedHook(SchedTCB_t *pxTCB, TickType_t xTickCount);
@@ -94,11 +341,30 @@ static void prvCheckDeadline(SchedTCB_t *pxTCB, TickType_t xTickCount);
 #endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 
 #if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
-static void prvExecTimeExceedHook(TickType_t xTickCount, SchedTCB_t *pxCurrentTask);
+static BaseType_t prvExecTimeExceedHook(TickType_t xTickCount, SchedTCB_t *pxCurrentTask);
+static BaseType_t prvCheckExecTimeFromISR(SchedTCB_t *pxCurrentTask);
 #endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
+#if (schedUSE_BUDGET_TIMER == 1)
+static void prvBudgetTimerArm(SchedTCB_t *pxTCB);
+static void prvBudgetTimerExpired(void);
+static void prvBudgetTimerStart(uint32_t ulCounts);
+static void prvBudgetTimerStop(void);
+#endif /* schedUSE_BUDGET_TIMER */
+
 #endif /* schedUSE_SCHEDULER_TASK */
 
+#if (schedUSE_TRACE == 1)
+static void prvTracePut(uint32_t ulTimestamp, uint8_t ucEvent, uint8_t ucTask, uint16_t usArg);
+static void prvTraceRecord(uint8_t ucEvent, SchedTCB_t *pxTCB, uint16_t usArg);
+static void prvTrace(uint8_t ucEvent, SchedTCB_t *pxTCB, uint16_t usArg);
+static void prvTraceWakeFromISR(void);
+static void prvTraceSend(uint32_t ulTimestamp, uint8_t ucEvent, uint8_t ucTask, uint16_t usArg);
+static void prvTraceDescribeTask(uint8_t ucTask);
+static void prvTraceTask(void *pvParameters);
+static void prvCreateTraceTask(void);
+#endif /* schedUSE_TRACE */
+
 #if (schedUSE_TCB_ARRAY == 1)
 /* Array for extended TCBs. */
 static SchedTCB_t xTCBArray[schedMAX_NUMBER_OF_PERIODIC_TASKS] = {0};
@@ -108,33 +374,116 @@ static BaseType_t xTaskCounter = 0;
 
 static SchedRCB_t xRCBArray[schedMAX_NUMBER_OF_SHARED_RESOURCES] = {0};
 
+#if (schedUSE_SHARED_STACK == 1)
+/* Preemption levels in use, with their worker tasks. */
+static SchedLCB_t xLCBArray[schedMAX_NUMBER_OF_PREEMPTION_LEVELS] = {0};
+#endif /* schedUSE_SHARED_STACK */
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+/* pdTRUE if the response times and blocking terms stored in the TCBs are those
+ * of the current task set, so admission control can continue from them. */
+static BaseType_t xAnalysisCacheValid = pdFALSE;
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+/* Synchronous busy period of the current task set. */
+static uint32_t ulEDFBusyPeriod = 0;
+/* Interval whose demand exceeded it in the last test, 0 if none did. */
+static uint32_t ulEDFOverload = 0;
+#endif /* schedSCHEDULING_POLICY */
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
+#if (schedUSE_STATIC_ALLOCATION == 1)
+#if (schedUSE_STATIC_TASK_POOL == 1 && schedUSE_SHARED_STACK == 0)
+/* Task memory reserved for periodic tasks created with vSchedulerPeriodicTaskCreate. */
+static StaticTask_t xTaskBufferPool[schedSTATIC_TASK_POOL_SIZE];
+static StackType_t uxStackPool[schedSTATIC_TASK_POOL_SIZE][schedSTATIC_TASK_STACK_SIZE];
+#endif /* schedUSE_STATIC_TASK_POOL && schedUSE_SHARED_STACK */
+#if (schedUSE_SCHEDULER_TASK == 1)
+static StaticTask_t xSchedulerTaskBuffer;
+static StackType_t uxSchedulerStack[schedSCHEDULER_TASK_STACK_SIZE];
+#endif /* schedUSE_SCHEDULER_TASK */
+#if (schedUSE_TRACE == 1)
+static StaticTask_t xTraceTaskBuffer;
+static StackType_t uxTraceStack[schedTRACE_TASK_STACK_SIZE];
+#endif /* schedUSE_TRACE */
+#endif /* schedUSE_STATIC_ALLOCATION */
+
+#if (schedUSE_TRACE == 1)
+#if ((schedTRACE_BUFFER_LENGTH & (schedTRACE_BUFFER_LENGTH - 1)) != 0 || schedTRACE_BUFFER_LENGTH > 128)
+#error schedTRACE_BUFFER_LENGTH must be a power of two up to 128
+#endif /* schedTRACE_BUFFER_LENGTH */
+#if (schedMAX_NUMBER_OF_PERIODIC_TASKS > 32)
+#error schedUSE_TRACE supports up to 32 periodic tasks
+#endif /* schedMAX_NUMBER_OF_PERIODIC_TASKS */
+
+/* Ring buffer of trace records. Records are only added with interrupts
+ * disabled, so tasks, the tick hook and the context switch hooks never write
+ * at the same time. The trace task is the only reader and moves ucTraceTail
+ * without a critical section. One entry stays free to tell a full buffer from
+ * an empty one. */
+static volatile SchedTraceRecord_t xTraceBuffer[schedTRACE_BUFFER_LENGTH];
+static volatile uint8_t ucTraceHead = 0;
+static volatile uint8_t ucTraceTail = 0;
+/* Records lost since the last schedTRACE_DROPPED record, and the time the
+ * first of them was lost. Only used by the producers. */
+static uint16_t usTraceDropped = 0;
+static uint32_t ulTraceDropTime = 0;
+/* One bit per task slot whose name, period and deadline have been sent. */
+static uint32_t ulTraceDescribed = 0;
+/* The trace task sleeps until it is notified of new records. */
+static TaskHandle_t xTraceHandle = NULL;
+#endif /* schedUSE_TRACE */
+
+/* Extended TCB of the periodic task that is running, NULL for any other task.
+ * Maintained by the traceTASK_SWITCHED_IN hook. */
+static SchedTCB_t *volatile pxCurrentSchedTCB = NULL;
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+/* Binary min-heap of extended TCBs ordered by absolute deadline. It is only
+ * touched when a deadline changes, so an event costs O(log n) instead of a
+ * full sort of xTCBArray. */
+static SchedTCB_t *pxEDFHeap[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+static UBaseType_t uxEDFHeapSize = 0;
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+/* Job that currently owns schedEDF_RUNNING_PRIORITY. */
+static SchedTCB_t *pxEDFRunningTask = NULL;
+#else
+/* Tasks that hold a distinct priority level, earliest deadline first. */
+static SchedTCB_t *pxEDFRankedTasks[schedEDF_RANKED_TASKS] = {0};
+static UBaseType_t uxEDFRankedCount = 0;
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+/* pdTRUE if the heap changed since priorities were last assigned. */
+static BaseType_t xEDFOrderChanged = pdFALSE;
+#endif /* schedSCHEDULING_POLICY */
+
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+/* Highest preemption ceiling of the resources in use, kept as relative
+ * deadline like the ceilings themselves. portMAX_DELAY if no resource is held. */
+static TickType_t xSRPSystemCeiling = portMAX_DELAY;
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+/* Resources in use, chained by priority ceiling, and the highest ceiling of a
+ * resource in use (the system ceiling), -1 if no resource is held. */
+static SchedRCB_t *pxOPCPInUse[configMAX_PRIORITIES] = {NULL};
+static BaseType_t xOPCPSystemCeiling = -1;
+#endif /* schedSUB_SCHEDULING_POLICY */
+
 #if (schedUSE_SCHEDULER_TASK)
-static TickType_t xSchedulerWakeCounter = 0; /* useful. why? */
 static TaskHandle_t xSchedulerHandle = NULL; /* useful. why? */
+
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1)
+static TickType_t xSchedulerNextWakeTime = 0;	  /* Tick at which the tick hook wakes the scheduler task. */
+static BaseType_t xSchedulerWakeArmed = pdFALSE; /* pdTRUE if xSchedulerNextWakeTime is valid. */
+#else
+static TickType_t xSchedulerWakeCounter = 0; /* useful. why? */
+#endif												 /* schedUSE_EVENT_DRIVEN_SCHEDULER */
 #endif										 /* schedUSE_SCHEDULER_TASK */
 
 #if (schedUSE_TCB_ARRAY == 1)
-/* Returns index position in xTCBArray of TCB with same task handle as parameter. */
-static BaseType_t prvGetTCBIndexFromHandle(TaskHandle_t xTaskHandle)
+/* Returns the extended TCB of a periodic task. The pointer is stored in the
+ * application task tag when the task is created, so the lookup takes constant
+ * time. Returns NULL for tasks that were not created by this module. */
+static SchedTCB_t *prvGetTCBFromHandle(TaskHandle_t xTaskHandle)
 {
-	static BaseType_t xIndex = 0;
-	BaseType_t xIterator;
-
-	for (xIterator = 0; xIterator < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIterator++)
-	{
-
-		if (pdTRUE == xTCBArray[xIndex].xInUse && *xTCBArray[xIndex].pxTaskHandle == xTaskHandle)
-		{
-			return xIndex;
-		}
-
-		xIndex++;
-		if (schedMAX_NUMBER_OF_PERIODIC_TASKS == xIndex)
-		{
-			xIndex = 0;
-		}
-	}
-	return -1;
+	return (SchedTCB_t *)xTaskGetApplicationTaskTag(xTaskHandle);
 }
 
 /* Initializes xTCBArray. */
@@ -159,9 +508,245 @@ static void prvInitRCBArray(void)
 
 		pxRCB->priorityCeiling = 0;
 		pxRCB->xInUse = pdFALSE;
-		pxRCB->xMutexSem = xSemaphoreCreateMutex();
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+		pxRCB->pxNextInUse = NULL;
+#endif /* schedSUB_SCHEDULING_POLICY */
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+		/* Resources are never waited for, so no mutex is needed. */
+		pxRCB->xPreemptionCeiling = portMAX_DELAY;
+		pxRCB->xMutexSem = NULL;
+#elif (schedUSE_IPCP_FAST_PATH == 1)
+		/* Running at the ceiling already keeps every other user out. */
+		pxRCB->xMutexSem = NULL;
+#else
+		/* A binary semaphore, not a kernel mutex such as
+		 * xSemaphoreCreateMutexStatic makes. The scheduler sets the priorities
+		 * itself, while a mutex keeps the priority it lent until its holder
+		 * gives back every mutex. The scheduler task also gives back the
+		 * resources of a job it stops, which only the holder may do with a
+		 * mutex. In place of the inheritance of a mutex, IPCP raises the holder
+		 * to the ceiling, OPCP and PIP raise it to the tasks waiting for it,
+		 * see prvHeldPriority, and new EDF ranks keep it there. */
+#if (schedUSE_STATIC_ALLOCATION == 1)
+		pxRCB->xMutexSem = xSemaphoreCreateBinaryStatic(&pxRCB->xMutexBuffer);
+#else
+		pxRCB->xMutexSem = xSemaphoreCreateBinary();
+#endif /* schedUSE_STATIC_ALLOCATION */
+		xSemaphoreGive(pxRCB->xMutexSem);
+#endif /* schedSUB_SCHEDULING_POLICY */
+	}
+}
+
+/* Puts a resource the task has just taken on its held stack. */
+static void prvPushHeldResource(SchedTCB_t *pxTCB, BaseType_t xResourceIndex)
+{
+	configASSERT(pxTCB->uxHeldCount < schedMAX_RESOURCES_PER_TASK);
+	pxTCB->xHeldResource[pxTCB->uxHeldCount] = xResourceIndex;
+	pxTCB->uxHeldCount++;
+}
+
+/* Takes a released resource off the held stack of the task. Resources are
+ * normally released in the reverse order they were taken, but any held one
+ * may go first. */
+static void prvPopHeldResource(SchedTCB_t *pxTCB, BaseType_t xResourceIndex)
+{
+	UBaseType_t uxHeld = pxTCB->uxHeldCount;
+
+	while (uxHeld > 0 && pxTCB->xHeldResource[uxHeld - 1] != xResourceIndex)
+	{
+		uxHeld--;
+	}
+	configASSERT(uxHeld > 0);
+	if (0 == uxHeld)
+	{
+		return;
+	}
+
+	for (; uxHeld < pxTCB->uxHeldCount; uxHeld++)
+	{
+		pxTCB->xHeldResource[uxHeld - 1] = pxTCB->xHeldResource[uxHeld];
+	}
+	pxTCB->uxHeldCount--;
+}
+
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+/* Chains a resource that was just taken to the others of its ceiling and
+ * raises the system ceiling. Must be called inside a critical section. */
+static void prvOPCPLock(SchedRCB_t *pxRCB)
+{
+	configASSERT(pxRCB->priorityCeiling < configMAX_PRIORITIES);
+	pxRCB->pxNextInUse = pxOPCPInUse[pxRCB->priorityCeiling];
+	pxOPCPInUse[pxRCB->priorityCeiling] = pxRCB;
+	if (pxRCB->priorityCeiling > xOPCPSystemCeiling)
+	{
+		xOPCPSystemCeiling = pxRCB->priorityCeiling;
+	}
+}
+
+/* Unchains a resource that was given back. Once no resource of the system
+ * ceiling is left in use, the system ceiling drops to the next ceiling in use.
+ * Must be called inside a critical section. */
+static void prvOPCPUnlock(SchedRCB_t *pxRCB)
+{
+	SchedRCB_t **ppxLink = &pxOPCPInUse[pxRCB->priorityCeiling];
+
+	while (NULL != *ppxLink && pxRCB != *ppxLink)
+	{
+		ppxLink = &(*ppxLink)->pxNextInUse;
+	}
+	configASSERT(NULL != *ppxLink);
+	if (NULL != *ppxLink)
+	{
+		*ppxLink = pxRCB->pxNextInUse;
+	}
+
+	while (xOPCPSystemCeiling >= 0 && NULL == pxOPCPInUse[xOPCPSystemCeiling])
+	{
+		xOPCPSystemCeiling--;
+	}
+}
+
+/* Chains the resources in use again after their ceilings changed. Must be
+ * called inside a critical section. */
+static void prvOPCPRebuildSystemCeiling(void)
+{
+	BaseType_t xIter;
+
+	for (xIter = 0; xIter < configMAX_PRIORITIES; xIter++)
+	{
+		pxOPCPInUse[xIter] = NULL;
+	}
+	xOPCPSystemCeiling = -1;
+
+	for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
+	{
+		if (pdTRUE == xRCBArray[xIter].xInUse)
+		{
+			prvOPCPLock(&xRCBArray[xIter]);
+		}
+	}
+}
+
+/* Returns a resource held by another task that keeps a task of priority
+ * xPriority from taking a free resource, NULL if the task may take it. The task
+ * may if its priority is above the system ceiling, or if it holds every
+ * resource of the system ceiling itself, so only those are looked at. Must be
+ * called inside a critical section. */
+static SchedRCB_t *prvOPCPBlockingResource(TaskHandle_t xTaskHandle, BaseType_t xPriority)
+{
+	SchedRCB_t *pxRCB;
+
+	if (xPriority > xOPCPSystemCeiling)
+	{
+		return NULL;
+	}
+
+	for (pxRCB = pxOPCPInUse[xOPCPSystemCeiling]; NULL != pxRCB; pxRCB = pxRCB->pxNextInUse)
+	{
+		if (pxRCB->xMutexHolder != xTaskHandle)
+		{
+			return pxRCB;
+		}
+	}
+
+	return NULL;
+}
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP))
+/* Returns the priority a task runs at while it holds the resources on its
+ * held stack: its base priority, raised to the ceiling of every held resource
+ * under IPCP, or to the priority of every task waiting for one under OPCP and
+ * PIP. */
+static UBaseType_t prvHeldPriority(SchedTCB_t *pxTCB)
+{
+	UBaseType_t uxPriority = pxTCB->uxBasePriority;
+	UBaseType_t uxHeld;
+
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP)
+	for (uxHeld = 0; uxHeld < pxTCB->uxHeldCount; uxHeld++)
+	{
+		if ((UBaseType_t)xRCBArray[pxTCB->xHeldResource[uxHeld]].priorityCeiling > uxPriority)
+		{
+			uxPriority = (UBaseType_t)xRCBArray[pxTCB->xHeldResource[uxHeld]].priorityCeiling;
+		}
+	}
+#else
+	BaseType_t xIndex;
+	SchedTCB_t *pxWaiting;
+	UBaseType_t uxWaitingPriority;
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxWaiting = &xTCBArray[xIndex];
+		if (pdFALSE == pxWaiting->xInUse || pdFALSE == pxWaiting->xBlocked)
+		{
+			continue;
+		}
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+		/* The waiting task may run at a priority it inherited itself. */
+		uxWaitingPriority = uxTaskPriorityGet(*pxWaiting->pxTaskHandle);
+#else
+		uxWaitingPriority = pxWaiting->uxPriority;
+#endif /* schedSUB_SCHEDULING_POLICY */
+		if (uxWaitingPriority <= uxPriority)
+		{
+			continue;
+		}
+
+		for (uxHeld = 0; uxHeld < pxTCB->uxHeldCount; uxHeld++)
+		{
+			if (pxTCB->xHeldResource[uxHeld] == pxWaiting->xBlockedResource)
+			{
+				uxPriority = uxWaitingPriority;
+				break;
+			}
+		}
+	}
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+	return uxPriority;
+}
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+/* Lends the priority of a task that starts to wait for pxRCB to its holder,
+ * and on down the chain as long as the holder waits for a resource as well.
+ * Must be called inside a critical section. */
+static void prvPIPInheritPriority(SchedRCB_t *pxRCB)
+{
+	BaseType_t xDepth;
+	SchedTCB_t *pxHolder;
+	UBaseType_t uxPriority;
+
+	/* Every task is at most once in a chain, a longer one is a deadlock. */
+	for (xDepth = 0; xDepth < schedMAX_NUMBER_OF_PERIODIC_TASKS; xDepth++)
+	{
+		if (NULL == pxRCB->xMutexHolder)
+		{
+			return;
+		}
+
+		pxHolder = prvGetTCBFromHandle(pxRCB->xMutexHolder);
+		uxPriority = prvHeldPriority(pxHolder);
+		if (uxPriority != uxTaskPriorityGet(pxRCB->xMutexHolder))
+		{
+			vTaskPrioritySet(pxRCB->xMutexHolder, uxPriority);
+#if (schedUSE_TRACE == 1)
+			prvTraceRecord(schedTRACE_PRIORITY, pxHolder, (uint16_t)uxPriority);
+#endif /* schedUSE_TRACE */
+		}
+
+		if (pdFALSE == pxHolder->xBlocked)
+		{
+			return;
+		}
+		pxRCB = &xRCBArray[pxHolder->xBlockedResource];
 	}
+
+	configASSERT(pdFALSE);
 }
+#endif /* schedSUB_SCHEDULING_POLICY */
 
 /* Find index for an empty entry in xTCBArray. Returns -1 if there is no empty entry. */
 static BaseType_t prvFindEmptyElementIndexTCB(void)
@@ -184,88 +769,309 @@ static void prvDeleteTCBFromArray(BaseType_t xIndex)
 	/* your implementation goes here */
 	xTCBArray[xIndex].xInUse = pdFALSE;
 	xTaskCounter--;
+#if (schedUSE_SHARED_STACK == 1)
+	xTCBArray[xIndex].pxLevel->uxTaskCount--;
+#endif /* schedUSE_SHARED_STACK */
 }
 
 #endif /* schedUSE_TCB_ARRAY */
 
-/* The whole function code that is executed by every periodic task.
- * This function wraps the task code specified by the user. */
-static void prvPeriodicTaskCode(void *pvParameters)
+/* Runs one job of a periodic task that has just been released. When the job
+ * completes the task leaves the dispatcher and the deadline miss policy of a
+ * late job is applied. */
+static void prvPeriodicJob(SchedTCB_t *pxThisTask)
 {
-	static BaseType_t xIndex = 0;
-	SchedTCB_t *pxThisTask;
-	TaskHandle_t xCurrentTaskHandle = xTaskGetCurrentTaskHandle();
-
-	/* your implementation goes here */
-	xIndex = prvGetTCBIndexFromHandle(xCurrentTaskHandle);
-	pxThisTask = &xTCBArray[xIndex];
-
-	/* Check the handle is not NULL. */
-	configASSERT(pxThisTask != NULL);
+	/* A new job has been released. Its budget starts now, so the time the task
+	 * ran between the last completion and this release is not charged to it. */
+	pxThisTask->xWorkIsDone = pdFALSE;
+	taskENTER_CRITICAL();
+	pxThisTask->xExecTime = 0;
+	pxThisTask->xSwitchInTime = schedEXEC_TIME_NOW();
+	pxThisTask->xExecStart = pdTRUE;
+#if (schedUSE_BUDGET_TIMER == 1)
+	prvBudgetTimerArm(pxThisTask);
+#endif /* schedUSE_BUDGET_TIMER */
+	taskEXIT_CRITICAL();
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+	pxThisTask->xJobBlockingTime = 0;
+#endif /* schedSUB_SCHEDULING_POLICY */
+#if (schedUSE_TRACE == 1)
+	prvTrace(schedTRACE_JOB_RELEASE, pxThisTask, (uint16_t)(xTaskGetTickCount() - pxThisTask->xLastWakeTime));
+#endif /* schedUSE_TRACE */
 
-	/* If required, use the handle to obtain further information about the task. */
-	/* You may find the following code helpful...
-	BaseType_t xIndex;
-	for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
-	{
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF && schedUSE_EDF_PRIORITY_BANDS == 1)
+	/* The task was waiting at schedEDF_RELEASE_PRIORITY, so it gets here right
+	 * at its release and can hand itself over to the dispatcher. */
+	taskENTER_CRITICAL();
+	pxThisTask->xAbsoluteDeadline = pxThisTask->xLastWakeTime + pxThisTask->xRelativeDeadline;
+	prvEDFJobReady(pxThisTask);
+	taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY && schedUSE_EDF_PRIORITY_BANDS */
 
-	}
-	*/
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1 && schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
+	/* Let the scheduler look at this job again once its deadline has passed. */
+	taskENTER_CRITICAL();
+	prvSchedulerWakeAt(pxThisTask->xLastWakeTime + pxThisTask->xRelativeDeadline + 1);
+	taskEXIT_CRITICAL();
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER && schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 
+	/* Execute the task function specified by the user. */
 #if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
-	/* your implementation goes here */
-	pxThisTask->xExecutedOnce = pdTRUE;
-#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
-
-	if (0 == pxThisTask->xReleaseTime)
+	if (pdTRUE == pxThisTask->xDegraded)
 	{
-		pxThisTask->xLastWakeTime = xSystemStartTime;
+		pxThisTask->pvDegradedTaskCode(pxThisTask->pvParameters);
 	}
 	else
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 	{
-		xTaskDelayUntil(&pxThisTask->xLastWakeTime, pxThisTask->xReleaseTime);
+		pxThisTask->pvTaskCode(pxThisTask->pvParameters);
 	}
 
-	for (;;)
-	{
-		pxThisTask->xExecStart = pdTRUE;
-
-		// for (BaseType_t xIter = 0; xIter < xTaskCounter; xIter++)
-		// {
-		// 	Serial.println(xTCBArray[xIter].uxPriority);
-		// }
-
-		/* Execute the task function specified by the user. */
-		pxThisTask->pvTaskCode(pvParameters);
-
-		pxThisTask->xWorkIsDone = pdTRUE;
-		pxThisTask->xExecStart = pdFALSE;
-		pxThisTask->xExecTime = 0;
+	pxThisTask->xWorkIsDone = pdTRUE;
+	pxThisTask->xExecStart = pdFALSE;
+#if (schedUSE_TRACE == 1)
+	taskENTER_CRITICAL();
+	prvTraceRecord(schedTRACE_JOB_COMPLETE, pxThisTask, 0);
+	taskEXIT_CRITICAL();
+#endif /* schedUSE_TRACE */
 
 #if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
-		pxThisTask->xAbsoluteDeadline = pxThisTask->xLastWakeTime + pxThisTask->xPeriod + pxThisTask->xRelativeDeadline;
-		prvWakeScheduler();
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+	/* Wait for the next release above the running band. */
+	taskENTER_CRITICAL();
+	prvEDFJobNotReady(pxThisTask, schedEDF_RELEASE_PRIORITY);
+	taskEXIT_CRITICAL();
+#else
+	taskENTER_CRITICAL();
+	pxThisTask->xAbsoluteDeadline = pxThisTask->xLastWakeTime + pxThisTask->xPeriod + pxThisTask->xRelativeDeadline;
+	prvEDFDeadlineChanged(pxThisTask);
+	taskEXIT_CRITICAL();
+	prvWakeScheduler();
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
 #endif /* schedSCHEDULING_POLICY */
 
-		xTaskDelayUntil(&pxThisTask->xLastWakeTime, pxThisTask->xPeriod);
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
+	/* Apply the miss policy of a job that finished late. Releases that were
+	 * passed meanwhile are caught up by xTaskDelayUntil, which returns at once. */
+	if (pdTRUE == pxThisTask->xDeadlineMissed)
+	{
+		pxThisTask->xDeadlineMissed = pdFALSE;
+		if (schedDEADLINE_MISS_SKIP_NEXT == pxThisTask->xMissPolicy)
+		{
+			pxThisTask->xLastWakeTime += pxThisTask->xPeriod;
+		}
+		else if (schedDEADLINE_MISS_DEGRADE == pxThisTask->xMissPolicy)
+		{
+			pxThisTask->xDegraded = pdTRUE;
+		}
+	}
+	else
+	{
+		/* A job that met its deadline ends the degraded mode. */
+		pxThisTask->xDegraded = pdFALSE;
 	}
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
 }
 
-/* Creates a periodic task. */
-void vSchedulerPeriodicTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
-								  TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, TickType_t xRTickArray[schedMAX_NUMBER_OF_SHARED_RESOURCES])
+#if (schedUSE_SHARED_STACK == 1)
+/* Returns the level of the tasks with relative deadline xRelativeDeadline,
+ * or takes a free level for it. Returns NULL if all levels are in use by other
+ * deadlines. Must be called inside a critical section. */
+static SchedLCB_t *prvFindLevel(TickType_t xRelativeDeadline)
 {
-	taskENTER_CRITICAL();
-
-	BaseType_t xIter = 0;
-	SchedTCB_t *pxNewTCB;
+	SchedLCB_t *pxFree = NULL;
+	BaseType_t xIndex;
 
-#if (schedUSE_TCB_ARRAY == 1)
-	BaseType_t xIndex = prvFindEmptyElementIndexTCB();
-	configASSERT(xTaskCounter < schedMAX_NUMBER_OF_PERIODIC_TASKS);
-	configASSERT(xIndex != -1);
-	pxNewTCB = &xTCBArray[xIndex];
-#endif /* schedUSE_TCB_ARRAY */
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PREEMPTION_LEVELS; xIndex++)
+	{
+		if (0 == xLCBArray[xIndex].uxTaskCount)
+		{
+			if (NULL == pxFree)
+			{
+				pxFree = &xLCBArray[xIndex];
+			}
+		}
+		else if (xRelativeDeadline == xLCBArray[xIndex].xRelativeDeadline)
+		{
+			return &xLCBArray[xIndex];
+		}
+	}
+
+	if (NULL != pxFree)
+	{
+		pxFree->xRelativeDeadline = xRelativeDeadline;
+	}
+
+	return pxFree;
+}
+
+/* Returns the task of pxLevel with the earliest pending release and stores
+ * the release in *pxRelease. Returns NULL if the level has no task. Must be
+ * called inside a critical section. */
+static SchedTCB_t *prvLevelNextRelease(SchedLCB_t *pxLevel, TickType_t *pxRelease)
+{
+	SchedTCB_t *pxNext = NULL, *pxTCB;
+	BaseType_t xIndex;
+	TickType_t xRelease;
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse || pxLevel != pxTCB->pxLevel || pdTRUE == pxTCB->xDeletePending)
+		{
+			continue;
+		}
+
+		xRelease = pxTCB->xLastWakeTime + pxTCB->xReleaseTime;
+		if (NULL == pxNext || schedTIME_BEFORE(xRelease, *pxRelease))
+		{
+			pxNext = pxTCB;
+			*pxRelease = xRelease;
+		}
+	}
+
+	return pxNext;
+}
+
+/* Function of the worker task of a level. It releases the task of the level
+ * with the earliest pending release and runs that job to completion before it
+ * looks at the next release. Jobs at the same level cannot preempt each other,
+ * so nothing is delayed by running them in turn. While a job runs the task tag
+ * points to its task, for the context switch hooks and prvGetTCBFromHandle. */
+static void prvLevelWorkerCode(void *pvParameters)
+{
+	SchedLCB_t *pxLevel = (SchedLCB_t *)pvParameters;
+	SchedTCB_t *pxThisTask;
+	TickType_t xNow, xRelease = 0;
+
+	for (;;)
+	{
+		taskENTER_CRITICAL();
+		xNow = xTaskGetTickCount();
+		pxThisTask = prvLevelNextRelease(pxLevel, &xRelease);
+		taskEXIT_CRITICAL();
+
+		/* A task admitted to the level notifies the worker, which then looks
+		 * for the next release again. */
+		if (NULL == pxThisTask)
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			continue;
+		}
+		if (schedTIME_BEFORE(xNow, xRelease))
+		{
+			ulTaskNotifyTake(pdTRUE, xRelease - xNow);
+			continue;
+		}
+
+		/* Releases that were passed meanwhile are caught up one by one, as
+		 * xTaskDelayUntil does for a task of its own. */
+		taskENTER_CRITICAL();
+		pxThisTask->xLastWakeTime = xRelease;
+		pxThisTask->xReleaseTime = pxThisTask->xPeriod;
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
+		pxThisTask->xExecutedOnce = pdTRUE;
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+		vTaskSetApplicationTaskTag(NULL, (TaskHookFunction_t)pxThisTask);
+		pxCurrentSchedTCB = pxThisTask;
+		pxThisTask->xExecTime = 0;
+		pxThisTask->xSwitchInTime = schedEXEC_TIME_NOW();
+#if (schedUSE_TRACE == 1)
+		prvTraceRecord(schedTRACE_SWITCH_IN, pxThisTask, 0);
+#endif /* schedUSE_TRACE */
+		taskEXIT_CRITICAL();
+
+		prvPeriodicJob(pxThisTask);
+
+		taskENTER_CRITICAL();
+#if (schedUSE_TRACE == 1)
+		prvTraceRecord(schedTRACE_SWITCH_OUT, pxThisTask, 0);
+#endif /* schedUSE_TRACE */
+		vTaskSetApplicationTaskTag(NULL, NULL);
+		pxCurrentSchedTCB = NULL;
+		taskEXIT_CRITICAL();
+	}
+}
+#else
+/* The whole function code that is executed by every periodic task.
+ * This function wraps the task code specified by the user. */
+static void prvPeriodicTaskCode(void *pvParameters)
+{
+	SchedTCB_t *pxThisTask;
+	TaskHandle_t xCurrentTaskHandle = xTaskGetCurrentTaskHandle();
+
+	/* your implementation goes here */
+	pxThisTask = prvGetTCBFromHandle(xCurrentTaskHandle);
+
+	/* Check the handle is not NULL. */
+	configASSERT(pxThisTask != NULL);
+
+	/* If required, use the handle to obtain further information about the task. */
+	/* You may find the following code helpful...
+	BaseType_t xIndex;
+	for( xIndex = 0; xIndex < xTaskCounter; xIndex++ )
+	{
+
+	}
+	*/
+
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
+	/* your implementation goes here */
+	pxThisTask->xExecutedOnce = pdTRUE;
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+
+	/* xLastWakeTime is the reference point of the first release. It is set on
+	 * creation and kept on recreation, so xTaskDelayUntil handles tick overflow. */
+	if (0 != pxThisTask->xReleaseTime)
+	{
+		xTaskDelayUntil(&pxThisTask->xLastWakeTime, pxThisTask->xReleaseTime);
+	}
+
+	for (;;)
+	{
+		prvPeriodicJob(pxThisTask);
+		xTaskDelayUntil(&pxThisTask->xLastWakeTime, pxThisTask->xPeriod);
+	}
+}
+#endif /* schedUSE_SHARED_STACK */
+
+/* Fills a free extended TCB for a new periodic task and returns it. Returns
+ * NULL if all schedMAX_NUMBER_OF_PERIODIC_TASKS slots are in use. */
+static SchedTCB_t *prvPeriodicTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
+										 TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, const SchedResourceUse_t *pxResourceUse,
+										 UBaseType_t uxResourceUseCount, BaseType_t xMissPolicy, TaskFunction_t pvDegradedTaskCode)
+{
+	taskENTER_CRITICAL();
+
+	UBaseType_t uxUse;
+	SchedTCB_t *pxNewTCB;
+
+	configASSERT(uxResourceUseCount <= schedMAX_RESOURCES_PER_TASK);
+	configASSERT(NULL != pxResourceUse || 0 == uxResourceUseCount);
+
+#if (schedUSE_TCB_ARRAY == 1)
+	BaseType_t xIndex = prvFindEmptyElementIndexTCB();
+	configASSERT((uint32_t)xPhaseTick + xDeadlineTick < schedMAX_TICK_SPAN);
+	configASSERT((uint32_t)xPeriodTick + xDeadlineTick < schedMAX_TICK_SPAN);
+	if (-1 == xIndex)
+	{
+		taskEXIT_CRITICAL();
+		return NULL;
+	}
+	pxNewTCB = &xTCBArray[xIndex];
+#endif /* schedUSE_TCB_ARRAY */
+
+#if (schedUSE_SHARED_STACK == 1)
+	/* A new deadline needs a free level as well. */
+	SchedLCB_t *pxLevel = prvFindLevel(xDeadlineTick);
+	if (NULL == pxLevel)
+	{
+		taskEXIT_CRITICAL();
+		return NULL;
+	}
+	pxLevel->uxTaskCount++;
+	pxNewTCB->pxLevel = pxLevel;
+#endif /* schedUSE_SHARED_STACK */
 
 	/* Intialize item. */
 
@@ -284,14 +1090,16 @@ void vSchedulerPeriodicTaskCreate(TaskFunction_t pvTaskCode, const char *pcName,
 	pxNewTCB->xAbsoluteDeadline = xPhaseTick + xDeadlineTick;
 	pxNewTCB->xRelativeDeadline = xDeadlineTick;
 	pxNewTCB->xWorkIsDone = pdFALSE;
+	pxNewTCB->xDeletePending = pdFALSE;
 	pxNewTCB->xExecTime = 0;
-	pxNewTCB->xMaxExecTime = xMaxExecTimeTick;
+	pxNewTCB->xMaxExecTime = schedTICKS_TO_EXEC_TIME(xMaxExecTimeTick);
+	pxNewTCB->xMaxExecTimeTick = xMaxExecTimeTick;
 
 #if (schedUSE_TCB_ARRAY == 1)
 	pxNewTCB->xInUse = pdTRUE;
 #endif /* schedUSE_TCB_ARRAY */
 
-#if ((schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS) || (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DM))
+#if (schedUSE_FIXED_PRIORITIES)
 	/* member initialization */
 	/* your implementation goes here */
 	pxNewTCB->xPriorityIsSet = pdFALSE;
@@ -301,40 +1109,278 @@ void vSchedulerPeriodicTaskCreate(TaskFunction_t pvTaskCode, const char *pcName,
 	/* member initialization */
 	/* your implementation goes here */
 	pxNewTCB->xExecutedOnce = pdFALSE;
+	configASSERT(schedDEADLINE_MISS_DEGRADE != xMissPolicy || NULL != pvDegradedTaskCode);
+	pxNewTCB->xMissPolicy = xMissPolicy;
+	pxNewTCB->xDeadlineMissed = pdFALSE;
+	pxNewTCB->xDegraded = pdFALSE;
 #endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+	pxNewTCB->pvDegradedTaskCode = pvDegradedTaskCode;
 
 #if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
 	pxNewTCB->xSuspended = pdFALSE;
 	pxNewTCB->xMaxExecTimeExceeded = pdFALSE;
 #endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
-	/* DEBUG - SUNIL */
-	for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
+	for (uxUse = 0; uxUse < uxResourceUseCount; uxUse++)
 	{
-		pxNewTCB->xRTickArray[xIter] = xRTickArray[xIter];
+		configASSERT(pxResourceUse[uxUse].xResourceIndex >= 0 && pxResourceUse[uxUse].xResourceIndex < schedMAX_NUMBER_OF_SHARED_RESOURCES);
+		pxNewTCB->xResourceUse[uxUse] = pxResourceUse[uxUse];
 	}
+	pxNewTCB->uxResourceUseCount = uxResourceUseCount;
 
 	pxNewTCB->xExecStart = pdFALSE;
 	pxNewTCB->xBlocked = pdFALSE;
-	pxNewTCB->xResourceAccessed = pdFALSE;
+	pxNewTCB->uxHeldCount = 0;
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+	pxNewTCB->xJobBlockingTime = 0;
+	pxNewTCB->xMaxBlockingTime = 0;
+#endif /* schedSUB_SCHEDULING_POLICY */
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	pxNewTCB->xJobStarted = pdFALSE;
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	pxNewTCB->xPriorityIsSet = pdFALSE;
+	pxNewTCB->uxEDFHeapIndex = schedEDF_NOT_IN_HEAP;
+#if (schedUSE_EDF_PRIORITY_BANDS == 0)
+	prvEDFHeapInsert(pxNewTCB);
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+#endif /* schedSCHEDULING_POLICY */
 
 #if (schedUSE_TCB_ARRAY == 1)
 	xTaskCounter++;
 #endif /* schedUSE_TCB_SORTED_LIST */
 	taskEXIT_CRITICAL();
 	// Serial.println(pxNewTCB->xMaxExecTime);
+
+	return pxNewTCB;
+}
+
+/* Creates a periodic task. */
+void vSchedulerPeriodicTaskCreate(TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
+								  TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, const SchedResourceUse_t *pxResourceUse,
+								  UBaseType_t uxResourceUseCount, BaseType_t xMissPolicy, TaskFunction_t pvDegradedTaskCode)
+{
+	SchedTCB_t *pxNewTCB = prvPeriodicTaskCreate(pvTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, pxCreatedTask,
+												 xPhaseTick, xPeriodTick, xMaxExecTimeTick, xDeadlineTick, pxResourceUse, uxResourceUseCount,
+												 xMissPolicy, pvDegradedTaskCode);
+
+	if (NULL == pxNewTCB)
+	{
+		configASSERT(pdTRUE == xSchedulerRunning);
+		*pxCreatedTask = NULL;
+		return;
+	}
+
+#if (schedUSE_SHARED_STACK == 1)
+	/* The jobs run on the stack of the level worker. */
+	configASSERT(uxStackDepth <= schedSHARED_STACK_SIZE);
+#elif (schedUSE_STATIC_ALLOCATION == 1)
+#if (schedUSE_STATIC_TASK_POOL == 1)
+	/* Use the memory reserved for this slot. Free slots are taken lowest first,
+	 * so while no more than schedSTATIC_TASK_POOL_SIZE tasks exist every slot
+	 * in use has an entry. */
+	BaseType_t xIndex = pxNewTCB - xTCBArray;
+
+	configASSERT(xIndex < schedSTATIC_TASK_POOL_SIZE);
+	configASSERT(uxStackDepth <= schedSTATIC_TASK_STACK_SIZE);
+	pxNewTCB->puxStackBuffer = uxStackPool[xIndex];
+	pxNewTCB->pxTaskBuffer = &xTaskBufferPool[xIndex];
+#else
+	/* Without the pool every task must bring its own memory. */
+	configASSERT(pdFALSE);
+#endif /* schedUSE_STATIC_TASK_POOL */
+#endif /* schedUSE_SHARED_STACK */
+
+	prvAdmitTask(pxNewTCB);
+}
+
+#if (schedUSE_STATIC_ALLOCATION == 1 && schedUSE_SHARED_STACK == 0)
+/* Creates a periodic task that runs on the given stack and kernel TCB memory. */
+void vSchedulerPeriodicTaskCreateStatic(TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
+										TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, const SchedResourceUse_t *pxResourceUse,
+										UBaseType_t uxResourceUseCount, BaseType_t xMissPolicy, TaskFunction_t pvDegradedTaskCode, StackType_t *puxStackBuffer, StaticTask_t *pxTaskBuffer)
+{
+	SchedTCB_t *pxNewTCB;
+
+	configASSERT(NULL != puxStackBuffer && NULL != pxTaskBuffer);
+
+	pxNewTCB = prvPeriodicTaskCreate(pvTaskCode, pcName, uxStackDepth, pvParameters, uxPriority, pxCreatedTask,
+									 xPhaseTick, xPeriodTick, xMaxExecTimeTick, xDeadlineTick, pxResourceUse, uxResourceUseCount,
+									 xMissPolicy, pvDegradedTaskCode);
+	if (NULL == pxNewTCB)
+	{
+		configASSERT(pdTRUE == xSchedulerRunning);
+		*pxCreatedTask = NULL;
+		return;
+	}
+	pxNewTCB->puxStackBuffer = puxStackBuffer;
+	pxNewTCB->pxTaskBuffer = pxTaskBuffer;
+
+	prvAdmitTask(pxNewTCB);
+}
+#endif /* schedUSE_STATIC_ALLOCATION && schedUSE_SHARED_STACK */
+
+/* Removes a periodic task that is not running and frees its slot. A task that
+ * is not running is dropped by the kernel at once, so the slot and its task
+ * memory can be reused right away. */
+static void prvPeriodicTaskRemove(SchedTCB_t *pxTCB)
+{
+	TaskHandle_t xTaskHandle = *pxTCB->pxTaskHandle;
+#if (schedUSE_SHARED_STACK == 1)
+	SchedLCB_t *pxLevel = pxTCB->pxLevel;
+#endif /* schedUSE_SHARED_STACK */
+
+	taskENTER_CRITICAL();
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
+	prvReleaseHeldResources(pxTCB);
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	if (schedEDF_NOT_IN_HEAP != pxTCB->uxEDFHeapIndex)
+	{
+		prvEDFHeapRemove(pxTCB);
+	}
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+	prvUpdateEDFPriorities(pdTRUE);
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+#endif /* schedSCHEDULING_POLICY */
+	pxTCB->xDeletePending = pdFALSE;
+#if (schedUSE_TRACE == 1)
+	/* A task created later in this slot is described again. */
+	ulTraceDescribed &= ~(1UL << (pxTCB - xTCBArray));
+#endif /* schedUSE_TRACE */
+	prvDeleteTCBFromArray(pxTCB - xTCBArray);
+#if (schedUSE_SHARED_STACK == 1)
+	/* The handle of a level refers to the task whose job runs on the worker,
+	 * so the worker is dropped together with that job. */
+	configASSERT(pxTCB == prvGetTCBFromHandle(xTaskHandle));
+	pxLevel->xWorkerHandle = NULL;
+#endif /* schedUSE_SHARED_STACK */
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	/* Ceilings can only rise, so jobs held back by them may start now. */
+	prvSetPreemptionCeilings();
+	prvUpdateEDFPriorities(pdTRUE);
+#endif /* schedSUB_SCHEDULING_POLICY */
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+	/* Response times of the remaining tasks can only shrink, so the cached
+	 * values no longer work as starting points. */
+	xAnalysisCacheValid = pdFALSE;
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+	taskEXIT_CRITICAL();
+
+	vTaskDelete(xTaskHandle);
+
+#if (schedUSE_SHARED_STACK == 1)
+	/* The other tasks of the level go on with a new worker. */
+	if (0 != pxLevel->uxTaskCount)
+	{
+		BaseType_t xReturnValue = prvCreateLevelWorker(pxLevel);
+		configASSERT(pdPASS == xReturnValue);
+	}
+#endif /* schedUSE_SHARED_STACK */
 }
 
 /* Deletes a periodic task. */
 void vSchedulerPeriodicTaskDelete(TaskHandle_t xTaskHandle)
 {
 	/* your implementation goes here */
-	static BaseType_t xIndex = 0;
+	SchedTCB_t *pxTCB;
 
-	xIndex = prvGetTCBIndexFromHandle(xTaskHandle);
-	prvDeleteTCBFromArray(xIndex);
-	vTaskDelete(xTaskHandle);
+	if (NULL == xTaskHandle)
+	{
+		xTaskHandle = xTaskGetCurrentTaskHandle();
+	}
+	pxTCB = prvGetTCBFromHandle(xTaskHandle);
+	configASSERT(pxTCB != NULL);
+
+#if (schedUSE_SCHEDULER_TASK == 1)
+	if (xTaskGetCurrentTaskHandle() == xTaskHandle)
+	{
+		/* A task deleting itself leaves its memory to the idle task, and the slot
+		 * could be reused before the idle task gets to it. The scheduler task
+		 * removes the task instead, once it has stopped. */
+		pxTCB->xDeletePending = pdTRUE;
+		prvWakeScheduler();
+		vTaskSuspend(NULL);
+		return;
+	}
+#endif /* schedUSE_SCHEDULER_TASK */
+
+	prvPeriodicTaskRemove(pxTCB);
+}
+
+/* Creates the kernel task of a periodic task and links it to its extended TCB. */
+static BaseType_t prvCreateKernelTask(SchedTCB_t *pxTCB)
+{
+	BaseType_t xReturnValue;
+
+#if (schedUSE_SHARED_STACK == 1)
+	SchedLCB_t *pxLevel = pxTCB->pxLevel;
+
+	if (NULL == pxLevel->xWorkerHandle)
+	{
+		return prvCreateLevelWorker(pxLevel);
+	}
+
+	/* The worker of the level takes the task over. A waiting worker looks for
+	 * the next release again. */
+	*pxTCB->pxTaskHandle = pxLevel->xWorkerHandle;
+	xTaskNotifyGive(pxLevel->xWorkerHandle);
+	xReturnValue = pdPASS;
+#elif (schedUSE_STATIC_ALLOCATION == 1)
+	*pxTCB->pxTaskHandle = xTaskCreateStatic((TaskFunction_t)prvPeriodicTaskCode,
+											 pxTCB->pcName,
+											 pxTCB->uxStackDepth,
+											 pxTCB->pvParameters, pxTCB->uxPriority,
+											 pxTCB->puxStackBuffer, pxTCB->pxTaskBuffer);
+	xReturnValue = (NULL != *pxTCB->pxTaskHandle) ? pdPASS : pdFAIL;
+#else
+	xReturnValue = xTaskCreate((TaskFunction_t)prvPeriodicTaskCode,
+							   pxTCB->pcName,
+							   pxTCB->uxStackDepth,
+							   pxTCB->pvParameters, pxTCB->uxPriority,
+							   pxTCB->pxTaskHandle);
+#endif /* schedUSE_SHARED_STACK */
+
+#if (schedUSE_SHARED_STACK == 0)
+	if (pdPASS == xReturnValue)
+	{
+		vTaskSetApplicationTaskTag(*pxTCB->pxTaskHandle, (TaskHookFunction_t)pxTCB);
+	}
+#endif /* schedUSE_SHARED_STACK */
+
+	return xReturnValue;
+}
+
+#if (schedUSE_SHARED_STACK == 1)
+/* Creates the worker task of a level and hands its handle to all tasks of the
+ * level. The worker waits for releases in the release band like a periodic
+ * task of its own would. */
+static BaseType_t prvCreateLevelWorker(SchedLCB_t *pxLevel)
+{
+	BaseType_t xIndex;
+
+#if (schedUSE_STATIC_ALLOCATION == 1)
+	pxLevel->xWorkerHandle = xTaskCreateStatic(prvLevelWorkerCode, "Level", schedSHARED_STACK_SIZE, pxLevel, schedEDF_RELEASE_PRIORITY,
+											   pxLevel->uxWorkerStack, &pxLevel->xWorkerBuffer);
+#else
+	if (pdPASS != xTaskCreate(prvLevelWorkerCode, "Level", schedSHARED_STACK_SIZE, pxLevel, schedEDF_RELEASE_PRIORITY, &pxLevel->xWorkerHandle))
+	{
+		pxLevel->xWorkerHandle = NULL;
+	}
+#endif /* schedUSE_STATIC_ALLOCATION */
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		if (pdTRUE == xTCBArray[xIndex].xInUse && pxLevel == xTCBArray[xIndex].pxLevel)
+		{
+			*xTCBArray[xIndex].pxTaskHandle = pxLevel->xWorkerHandle;
+		}
+	}
+
+	return (NULL != pxLevel->xWorkerHandle) ? pdPASS : pdFAIL;
 }
+#endif /* schedUSE_SHARED_STACK */
 
 /* Creates all periodic tasks stored in TCB array, or TCB list. */
 static void prvCreateAllTasks(void)
@@ -343,273 +1389,1050 @@ static void prvCreateAllTasks(void)
 
 #if (schedUSE_TCB_ARRAY == 1)
 	BaseType_t xIndex;
-	for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
 	{
-		configASSERT(pdTRUE == xTCBArray[xIndex].xInUse);
 		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse)
+		{
+			continue;
+		}
+		pxTCB->xLastWakeTime = xSystemStartTime;
 
-		BaseType_t xReturnValue = xTaskCreate((TaskFunction_t)prvPeriodicTaskCode,
-											  pxTCB->pcName,
-											  pxTCB->uxStackDepth,
-											  pxTCB->pvParameters, pxTCB->uxPriority,
-											  pxTCB->pxTaskHandle);
+		BaseType_t xReturnValue = prvCreateKernelTask(pxTCB);
+		configASSERT(pdPASS == xReturnValue);
 	}
 #endif /* schedUSE_TCB_ARRAY */
 }
 
-#if ((schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS) || (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DM))
-/* Initiazes fixed priorities of all periodic tasks with respect to RMS or DM policy. */
-static void prvSetFixedPriorities(void)
+/* Admits a periodic task that was created while the scheduler is running. The
+ * kernel task is only created if the task set stays schedulable, otherwise the
+ * slot is freed again and the task handle set to NULL. Before vSchedulerStart
+ * nothing is done here, the task is created by prvCreateAllTasks. */
+static BaseType_t prvAdmitTask(SchedTCB_t *pxNewTCB)
 {
-	BaseType_t xIter, xIndex;
-	TickType_t xShortest, xPreviousShortest = 0;
-	SchedTCB_t *pxShortestTaskPointer;
+	BaseType_t xReturnValue = pdPASS;
+	const char *pcName = pxNewTCB->pcName;
+#if (schedUSE_FIXED_PRIORITIES)
+	BaseType_t xIndex, xFeasible;
+	SchedTCB_t *pxTCB;
+	UBaseType_t uxPreviousPriority[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+#endif /* schedSCHEDULING_POLICY */
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+	BaseType_t xSchedulable;
+#endif /* schedUSE_SCHEDULABILITY_TEST */
 
-#if (schedUSE_SCHEDULER_TASK == 1)
-	BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY;
+	if (pdFALSE == xSchedulerRunning)
+	{
+		return pdPASS;
+	}
+
+	/* No task may run on the priorities while they are reassigned. Nothing is
+	 * printed until the other tasks run again, Serial can block. */
+	vTaskSuspendAll();
+
+#if (schedUSE_FIXED_PRIORITIES)
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		uxPreviousPriority[xIndex] = xTCBArray[xIndex].uxBasePriority;
+	}
+	xFeasible = prvSetFixedPriorities();
+#elif (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+	pxNewTCB->uxPriority = schedEDF_RELEASE_PRIORITY;
+	pxNewTCB->uxBasePriority = schedEDF_RELEASE_PRIORITY;
 #else
-	BaseType_t xHighestPriority = configMAX_PRIORITIES;
-#endif /* schedUSE_SCHEDULER_TASK */
+	pxNewTCB->uxPriority = tskIDLE_PRIORITY;
+	pxNewTCB->uxBasePriority = tskIDLE_PRIORITY;
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+#endif /* schedSCHEDULING_POLICY */
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+	xSchedulable = prvCheckSchedulability(pxNewTCB);
+	xReturnValue = xSchedulable ? pdPASS : pdFAIL;
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
+	if (pdPASS == xReturnValue)
+	{
+#if (schedUSE_FIXED_PRIORITIES)
+		/* Move the other tasks to their new priorities. A task that holds
+		 * resources gets its new priority when it releases one of them. */
+		for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+		{
+			pxTCB = &xTCBArray[xIndex];
+			if (pdTRUE == pxTCB->xInUse && pxTCB != pxNewTCB && uxPreviousPriority[xIndex] != pxTCB->uxBasePriority && 0 == pxTCB->uxHeldCount)
+			{
+				vTaskPrioritySet(*pxTCB->pxTaskHandle, pxTCB->uxBasePriority);
+			}
+		}
+#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
+		taskENTER_CRITICAL();
+		prvComputePriorityCeilings();
+		taskEXIT_CRITICAL();
+#endif /* schedSUB_SCHEDULING_POLICY */
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+		/* The new task can only lower ceilings. Jobs that already started keep
+		 * running, the next job to start is checked against the new ceiling. */
+		taskENTER_CRITICAL();
+		prvSetPreemptionCeilings();
+		taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY */
+
+		/* The phase counts from now. */
+		pxNewTCB->xLastWakeTime = xTaskGetTickCount();
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+		taskENTER_CRITICAL();
+		pxNewTCB->xAbsoluteDeadline = pxNewTCB->xLastWakeTime + pxNewTCB->xReleaseTime + pxNewTCB->xRelativeDeadline;
+		prvEDFDeadlineChanged(pxNewTCB);
+		taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY */
+
+		xReturnValue = prvCreateKernelTask(pxNewTCB);
+	}
+#if (schedUSE_FIXED_PRIORITIES)
+	else
+	{
+		for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+		{
+			xTCBArray[xIndex].uxPriority = uxPreviousPriority[xIndex];
+			xTCBArray[xIndex].uxBasePriority = uxPreviousPriority[xIndex];
+		}
+	}
+#endif /* schedSCHEDULING_POLICY */
+
+	if (pdPASS != xReturnValue)
+	{
+		taskENTER_CRITICAL();
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+		if (schedEDF_NOT_IN_HEAP != pxNewTCB->uxEDFHeapIndex)
+		{
+			prvEDFHeapRemove(pxNewTCB);
+		}
+#endif /* schedSCHEDULING_POLICY */
+		prvDeleteTCBFromArray(pxNewTCB - xTCBArray);
+		*pxNewTCB->pxTaskHandle = NULL;
+		taskEXIT_CRITICAL();
+	}
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF && schedUSE_EDF_PRIORITY_BANDS == 0)
+	else
+	{
+		/* Rank the new task. */
+		prvWakeScheduler();
+	}
+#endif /* schedSCHEDULING_POLICY && schedUSE_EDF_PRIORITY_BANDS */
+
+	xTaskResumeAll();
+
+#if (schedUSE_FIXED_PRIORITIES)
+	if (pdPASS == xReturnValue)
+	{
+		prvPrintFixedPriorities(xFeasible);
+	}
+#endif /* schedSCHEDULING_POLICY */
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+	prvPrintSchedulability(pxNewTCB, xSchedulable);
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+	if (pdPASS == xReturnValue)
+	{
+#if (schedUSE_FIXED_PRIORITIES && ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP)))
+		prvPrintPriorityCeilings();
+#endif /* schedSCHEDULING_POLICY && schedSUB_SCHEDULING_POLICY */
+	}
+	else
+	{
+		Serial.print(pcName);
+		Serial.println(" not admitted");
+	}
+
+	return xReturnValue;
+}
+
+#if (schedUSE_FIXED_PRIORITIES)
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+/* Orders the periodic tasks with Audsley's optimal priority assignment. The
+ * rank of each slot is stored in pxRank, 0 for the task that gets the highest
+ * priority. Returns pdFALSE if no order lets every task meet its deadline. */
+static BaseType_t prvSetOPARanks(TickType_t *pxRank)
+{
+	SchedAnalysisTask_t xTasks[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+	SchedTCB_t *pxSlot[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+	size_t xCount = prvGetAnalysisTasks(xTasks, pxSlot);
+	size_t xUnplaced = xSchedAnalysisAudsley(xTasks, xCount, schedMAX_NUMBER_OF_SHARED_RESOURCES);
+	size_t xIndex;
+
+	for (xIndex = 0; xIndex < xCount; xIndex++)
+	{
+		pxRank[pxSlot[xIndex] - xTCBArray] = xCount - xTasks[xIndex].ulPriority;
+	}
+
+	return (0 == xUnplaced) ? pdTRUE : pdFALSE;
+}
+#endif /* schedSCHEDULING_POLICY */
+
+/* Initiazes fixed priorities of all periodic tasks with respect to RMS, DM or
+ * OPA policy. Prints nothing, see prvPrintFixedPriorities. Returns pdFALSE if
+ * OPA found no order in which every task meets its deadline. */
+static BaseType_t prvSetFixedPriorities(void)
+{
+	BaseType_t xIter, xIndex, xFeasible = pdTRUE;
+	TickType_t xShortest, xPreviousShortest = 0;
+	SchedTCB_t *pxShortestTaskPointer;
+
+#if (schedUSE_SCHEDULER_TASK == 1)
+	BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY;
+#else
+	BaseType_t xHighestPriority = configMAX_PRIORITIES;
+#endif /* schedUSE_SCHEDULER_TASK */
+
+	/* Tasks added after start get their priority together with all others. */
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		xTCBArray[xIndex].xPriorityIsSet = pdFALSE;
+	}
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+	TickType_t xOPARank[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+	xFeasible = prvSetOPARanks(xOPARank);
+#endif /* schedSCHEDULING_POLICY */
+
+	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	{
+		xShortest = portMAX_DELAY;
+
+		/* search for shortest period */
+		for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+		{
+			/* your implementation goes here */
+			if (xTCBArray[xIndex].xInUse == pdFALSE)
+				continue;
+			if (xTCBArray[xIndex].xPriorityIsSet == pdTRUE)
+				continue;
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS)
+			/* your implementation goes here */
+			if (xShortest > xTCBArray[xIndex].xPeriod)
+			{
+				xShortest = xTCBArray[xIndex].xPeriod;
+				pxShortestTaskPointer = &xTCBArray[xIndex];
+			}
+#endif /* schedSCHEDULING_POLICY */
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DM)
+			if (xShortest > xTCBArray[xIndex].xRelativeDeadline)
+			{
+				xShortest = xTCBArray[xIndex].xRelativeDeadline;
+				pxShortestTaskPointer = &xTCBArray[xIndex];
+			}
+#endif /* schedSCHEDULING_POLICY */
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+			if (xShortest > xOPARank[xIndex])
+			{
+				xShortest = xOPARank[xIndex];
+				pxShortestTaskPointer = &xTCBArray[xIndex];
+			}
+#endif /* schedSCHEDULING_POLICY */
+		}
+
+		/* set highest priority to task with xShortest period (the highest priority is configMAX_PRIORITIES-1) */
+
+		/* your implementation goes here */
+
+		if (xHighestPriority > 0)
+		{
+			xHighestPriority--;
+		}
+		else
+		{
+			xHighestPriority = 0;
+		}
+
+		configASSERT(0 <= xHighestPriority);
+		pxShortestTaskPointer->uxPriority = xHighestPriority;
+		pxShortestTaskPointer->uxBasePriority = pxShortestTaskPointer->uxPriority;
+		pxShortestTaskPointer->xPriorityIsSet = pdTRUE;
+		xPreviousShortest = xShortest;
+	}
+
+	return xFeasible;
+}
+
+/* Prints the priorities set by prvSetFixedPriorities. */
+static void prvPrintFixedPriorities(BaseType_t xFeasible)
+{
+	BaseType_t xIndex;
+	SchedTCB_t *pxTCB;
+
+	if (pdFALSE == xFeasible)
+	{
+		Serial.println("no feasible priority order");
+	}
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse)
+		{
+			continue;
+		}
+
+#if (schedUSE_TRACE == 1)
+		prvTrace(schedTRACE_PRIORITY, pxTCB, (uint16_t)pxTCB->uxPriority);
+#else
+		Serial.print(pxTCB->pcName);
+		Serial.print(" has priority ");
+		Serial.println(pxTCB->uxPriority);
+		// Serial.flush();
+#endif /* schedUSE_TRACE */
+	}
+}
+#endif /* schedSCHEDULING_POLICY */
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1 || schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+/* Describes all periodic tasks for the analysis module. The TCB of each entry
+ * is stored in ppxSlot. Returns the number of tasks. */
+static size_t prvGetAnalysisTasks(SchedAnalysisTask_t *pxTasks, SchedTCB_t **ppxSlot)
+{
+	size_t xCount = 0;
+	BaseType_t xIndex;
+	UBaseType_t uxUse;
+	SchedTCB_t *pxTCB;
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse)
+		{
+			continue;
+		}
+
+		pxTasks[xCount].ulPeriod = pxTCB->xPeriod;
+		pxTasks[xCount].ulDeadline = pxTCB->xRelativeDeadline;
+		pxTasks[xCount].ulExecTime = pxTCB->xMaxExecTimeTick;
+		pxTasks[xCount].ulPriority = pxTCB->uxPriority;
+		pxTasks[xCount].xResourceUseCount = 0;
+		for (uxUse = 0; uxUse < pxTCB->uxResourceUseCount; uxUse++)
+		{
+			xSchedAnalysisAddResource(&pxTasks[xCount], pxTCB->xResourceUse[uxUse].xResourceIndex, pxTCB->xResourceUse[uxUse].xHoldTick);
+		}
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+		/* Results of the last analysis, the starting point of an admission test. */
+		pxTasks[xCount].ulBlocking = pxTCB->xBlockingTime;
+		pxTasks[xCount].ulResponseTime = (portMAX_DELAY == pxTCB->xResponseTime) ? schedANALYSIS_UNSCHEDULABLE : pxTCB->xResponseTime;
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+		ppxSlot[xCount++] = pxTCB;
+	}
+
+	return xCount;
+}
+#endif /* schedUSE_SCHEDULABILITY_TEST || schedSCHEDULING_POLICY */
+
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+/* Runs the schedulability test of the scheduling policy on all periodic tasks:
+ * response time analysis under RMS and DM, the processor demand test under EDF.
+ * The worst-case response time of every task (its deadline under EDF) is stored
+ * in its TCB, see prvPrintSchedulability. If pxNewTCB is not NULL it is the
+ * admission test of that task, which continues from the results of the last
+ * analysis and leaves them untouched if the task is rejected. Returns pdFALSE
+ * if a deadline can be missed. */
+static BaseType_t prvCheckSchedulability(SchedTCB_t *pxNewTCB)
+{
+	SchedAnalysisTask_t xTasks[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+	SchedTCB_t *pxSlot[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+	size_t xCount = prvGetAnalysisTasks(xTasks, pxSlot);
+	size_t xMisses = 0, xIndex;
+#if (schedUSE_FIXED_PRIORITIES)
+	size_t xNewIndex;
+#endif /* schedSCHEDULING_POLICY */
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_OPA)
+	/* Audsley may reorder the old tasks, so cached results are no starting point. */
+	BaseType_t xIncremental = pdFALSE;
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+	/* A new task can add to the blocking of every task above it. */
+	BaseType_t xIncremental = pdFALSE;
+#else
+	BaseType_t xIncremental = (NULL != pxNewTCB && pdTRUE == xAnalysisCacheValid) ? pdTRUE : pdFALSE;
+#endif /* schedSCHEDULING_POLICY */
+	SchedTCB_t *pxTCB;
+
+#if (schedUSE_FIXED_PRIORITIES)
+	if (pdTRUE == xIncremental)
+	{
+		/* Only the new task and the tasks below it are analysed again. */
+		for (xNewIndex = 0; xNewIndex < xCount - 1 && pxSlot[xNewIndex] != pxNewTCB; xNewIndex++)
+		{
+		}
+		xMisses = xSchedAnalysisFixedPriorityAdmit(xTasks, xCount, schedMAX_NUMBER_OF_SHARED_RESOURCES, xNewIndex);
+	}
+	else
+	{
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+		xMisses = xSchedAnalysisFixedPriorityPIP(xTasks, xCount, schedMAX_NUMBER_OF_SHARED_RESOURCES);
+#else
+		xMisses = xSchedAnalysisFixedPriority(xTasks, xCount, schedMAX_NUMBER_OF_SHARED_RESOURCES);
+#endif /* schedSUB_SCHEDULING_POLICY */
+	}
+#elif (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	/* The busy period grows when a task is added, so the search continues from the cached one. */
+	uint32_t ulBusyPeriod = (pdTRUE == xIncremental) ? ulEDFBusyPeriod : 0;
+	ulEDFOverload = ulSchedAnalysisEDF(xTasks, xCount, schedMAX_NUMBER_OF_SHARED_RESOURCES, &ulBusyPeriod);
+
+	if (0 != ulEDFOverload)
+	{
+		xMisses = xCount;
+	}
+#endif /* schedSCHEDULING_POLICY */
+
+	/* A rejected task must not change the cached results. */
+	if (NULL != pxNewTCB && 0 != xMisses)
+	{
+		return pdFALSE;
+	}
+
+	xAnalysisCacheValid = pdTRUE;
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	ulEDFBusyPeriod = ulBusyPeriod;
+#endif /* schedSCHEDULING_POLICY */
+
+	for (xIndex = 0; xIndex < xCount; xIndex++)
+	{
+		pxTCB = pxSlot[xIndex];
+		pxTCB->xResponseTime = (schedANALYSIS_UNSCHEDULABLE == xTasks[xIndex].ulResponseTime) ? portMAX_DELAY : (TickType_t)xTasks[xIndex].ulResponseTime;
+		pxTCB->xBlockingTime = xTasks[xIndex].ulBlocking;
+	}
+
+	return (0 == xMisses) ? pdTRUE : pdFALSE;
+}
+
+/* Prints the result of prvCheckSchedulability, called with the same pxNewTCB:
+ * the response times of all tasks, or of the admitted task only. */
+static void prvPrintSchedulability(SchedTCB_t *pxNewTCB, BaseType_t xSchedulable)
+{
+	BaseType_t xIndex;
+	SchedTCB_t *pxTCB;
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	if (0 != ulEDFOverload)
+	{
+		Serial.print("EDF demand exceeds interval of ");
+		Serial.println(ulEDFOverload);
+	}
+#endif /* schedSCHEDULING_POLICY */
+
+	if (NULL != pxNewTCB && pdFALSE == xSchedulable)
+	{
+		Serial.print(pxNewTCB->pcName);
+		Serial.println(" would make the task set unschedulable");
+		return;
+	}
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse || (NULL != pxNewTCB && pxTCB != pxNewTCB))
+		{
+			continue;
+		}
+		Serial.print(pxTCB->pcName);
+		Serial.print(" response time ");
+		if (portMAX_DELAY == pxTCB->xResponseTime)
+		{
+			Serial.println("exceeds deadline");
+		}
+		else
+		{
+			Serial.println(pxTCB->xResponseTime);
+		}
+	}
+}
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+/* Returns pdTRUE if the job of pxA has an earlier absolute deadline than the job of pxB. */
+static BaseType_t prvEDFDeadlineBefore(SchedTCB_t *pxA, SchedTCB_t *pxB)
+{
+	return schedTIME_BEFORE(pxA->xAbsoluteDeadline, pxB->xAbsoluteDeadline) ? pdTRUE : pdFALSE;
+}
+
+/* Swaps two heap entries and keeps their back references up to date. */
+static void prvEDFHeapSwap(UBaseType_t uxA, UBaseType_t uxB)
+{
+	SchedTCB_t *pxTemp = pxEDFHeap[uxA];
+
+	pxEDFHeap[uxA] = pxEDFHeap[uxB];
+	pxEDFHeap[uxB] = pxTemp;
+	pxEDFHeap[uxA]->uxEDFHeapIndex = uxA;
+	pxEDFHeap[uxB]->uxEDFHeapIndex = uxB;
+}
+
+/* Moves the entry at uxIndex towards the root while its deadline is earlier than its parent's. */
+static void prvEDFHeapSiftUp(UBaseType_t uxIndex)
+{
+	UBaseType_t uxParent;
+
+	while (uxIndex > 0)
+	{
+		uxParent = (uxIndex - 1) / 2;
+		if (pdFALSE == prvEDFDeadlineBefore(pxEDFHeap[uxIndex], pxEDFHeap[uxParent]))
+		{
+			break;
+		}
+		prvEDFHeapSwap(uxIndex, uxParent);
+		uxIndex = uxParent;
+	}
+}
+
+/* Moves the entry at uxIndex towards the leaves while a child has an earlier deadline. */
+static void prvEDFHeapSiftDown(UBaseType_t uxIndex)
+{
+	UBaseType_t uxChild, uxEarliest;
+
+	for (;;)
+	{
+		uxEarliest = uxIndex;
+		uxChild = 2 * uxIndex + 1;
+
+		if (uxChild < uxEDFHeapSize && prvEDFDeadlineBefore(pxEDFHeap[uxChild], pxEDFHeap[uxEarliest]))
+		{
+			uxEarliest = uxChild;
+		}
+		uxChild++;
+		if (uxChild < uxEDFHeapSize && prvEDFDeadlineBefore(pxEDFHeap[uxChild], pxEDFHeap[uxEarliest]))
+		{
+			uxEarliest = uxChild;
+		}
+
+		if (uxEarliest == uxIndex)
+		{
+			break;
+		}
+		prvEDFHeapSwap(uxIndex, uxEarliest);
+		uxIndex = uxEarliest;
+	}
+}
+
+/* Adds a task to the deadline heap. Must be called inside a critical section. */
+static void prvEDFHeapInsert(SchedTCB_t *pxTCB)
+{
+	configASSERT(uxEDFHeapSize < schedMAX_NUMBER_OF_PERIODIC_TASKS);
+	configASSERT(schedEDF_NOT_IN_HEAP == pxTCB->uxEDFHeapIndex);
+
+	pxTCB->uxEDFHeapIndex = uxEDFHeapSize;
+	pxEDFHeap[uxEDFHeapSize] = pxTCB;
+	uxEDFHeapSize++;
+	prvEDFHeapSiftUp(pxTCB->uxEDFHeapIndex);
+	xEDFOrderChanged = pdTRUE;
+}
+
+/* Removes a task from the deadline heap. Must be called inside a critical section. */
+static void prvEDFHeapRemove(SchedTCB_t *pxTCB)
+{
+	UBaseType_t uxIndex = pxTCB->uxEDFHeapIndex;
+
+	configASSERT(uxIndex < uxEDFHeapSize && pxEDFHeap[uxIndex] == pxTCB);
+
+	uxEDFHeapSize--;
+	if (uxIndex != uxEDFHeapSize)
+	{
+		prvEDFHeapSwap(uxIndex, uxEDFHeapSize);
+		prvEDFHeapSiftUp(uxIndex);
+		prvEDFHeapSiftDown(pxEDFHeap[uxIndex]->uxEDFHeapIndex);
+	}
+	pxTCB->uxEDFHeapIndex = schedEDF_NOT_IN_HEAP;
+
+	/* A removed task must not be touched by the next priority update. */
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+	if (pxEDFRunningTask == pxTCB)
+	{
+		pxEDFRunningTask = NULL;
+	}
+#else
+	UBaseType_t uxRank;
+	for (uxRank = 0; uxRank < uxEDFRankedCount; uxRank++)
+	{
+		if (pxEDFRankedTasks[uxRank] == pxTCB)
+		{
+			pxEDFRankedTasks[uxRank] = pxEDFRankedTasks[--uxEDFRankedCount];
+			break;
+		}
+	}
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+	xEDFOrderChanged = pdTRUE;
+}
+
+/* Restores the heap order after the absolute deadline of pxTCB was modified.
+ * Must be called inside a critical section. */
+static void prvEDFDeadlineChanged(SchedTCB_t *pxTCB)
+{
+	if (schedEDF_NOT_IN_HEAP == pxTCB->uxEDFHeapIndex)
+	{
+		return;
+	}
+	prvEDFHeapSiftUp(pxTCB->uxEDFHeapIndex);
+	prvEDFHeapSiftDown(pxTCB->uxEDFHeapIndex);
+	xEDFOrderChanged = pdTRUE;
+}
+
+/* Sets the EDF priority of a task. The kernel is only called if the priority actually changed. */
+static void prvEDFSetPriority(SchedTCB_t *pxTCB, UBaseType_t uxPriority, BaseType_t xApplyToTask)
+{
+	if (pxTCB->uxPriority != uxPriority)
+	{
+		pxTCB->uxPriority = uxPriority;
+		pxTCB->uxBasePriority = uxPriority;
+		if (pdTRUE == xApplyToTask)
+		{
+#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
+			/* The resource semaphores lend no priority, so a new rank must not
+			 * drop a holder below what its resources raise it to. */
+			vTaskPrioritySet(*pxTCB->pxTaskHandle, prvHeldPriority(pxTCB));
+#else
+			vTaskPrioritySet(*pxTCB->pxTaskHandle, uxPriority);
+#endif /* schedSUB_SCHEDULING_POLICY */
+		}
+	}
+}
+
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+/* Called when a job is released. The job is handed to the dispatcher, which
+ * moves it into the running band if its deadline is the earliest, and is
+ * parked otherwise. The releasing task is usually pxTCB itself, and lowering
+ * its own priority makes the kernel switch tasks at once, so that is done
+ * last, when the dispatcher state is complete. Must be called inside a
+ * critical section. */
+static void prvEDFJobReady(SchedTCB_t *pxTCB)
+{
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	pxTCB->xJobStarted = pdFALSE;
+#endif /* schedSUB_SCHEDULING_POLICY */
+	prvEDFHeapInsert(pxTCB);
+	prvUpdateEDFPriorities(pdTRUE);
+	if (pxEDFRunningTask != pxTCB)
+	{
+		prvEDFSetPriority(pxTCB, schedEDF_PARKED_PRIORITY, pdTRUE);
+	}
+}
+
+/* Called when a job completes, is suspended or deleted. The task leaves the
+ * dispatcher and waits at uxPriority. Must be called inside a critical section. */
+static void prvEDFJobNotReady(SchedTCB_t *pxTCB, UBaseType_t uxPriority)
+{
+	if (schedEDF_NOT_IN_HEAP != pxTCB->uxEDFHeapIndex)
+	{
+		prvEDFHeapRemove(pxTCB);
+	}
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	pxTCB->xJobStarted = pdFALSE;
+#endif /* schedSUB_SCHEDULING_POLICY */
+	prvEDFSetPriority(pxTCB, uxPriority, pdTRUE);
+	prvUpdateEDFPriorities(pdTRUE);
+}
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+
+/* Initializes EDF priorities of all periodic tasks from their first absolute deadline. */
+static void prvSetEDFInitialPriorities(void)
+{
+	BaseType_t xIndex;
+	SchedTCB_t *pxTCB;
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+		/* Every task starts by registering its first release with the dispatcher. */
+		xTCBArray[xIndex].uxPriority = schedEDF_RELEASE_PRIORITY;
+		xTCBArray[xIndex].uxBasePriority = schedEDF_RELEASE_PRIORITY;
+#else
+		xTCBArray[xIndex].uxPriority = tskIDLE_PRIORITY;
+		xTCBArray[xIndex].uxBasePriority = tskIDLE_PRIORITY;
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+	}
+
+#if (schedUSE_EDF_PRIORITY_BANDS == 0)
+	xEDFOrderChanged = pdTRUE;
+	prvUpdateEDFPriorities(pdFALSE);
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse)
+		{
+			continue;
+		}
+
+#if (schedUSE_TRACE == 1)
+		prvTrace(schedTRACE_PRIORITY, pxTCB, (uint16_t)pxTCB->uxPriority);
+#else
+		Serial.print(pxTCB->pcName);
+		Serial.print(" has priority ");
+		Serial.println(pxTCB->uxPriority);
+		// Serial.flush();
+#endif /* schedUSE_TRACE */
+	}
+}
+
+#if (schedUSE_EDF_PRIORITY_BANDS == 1)
+/* Dispatches the job with the earliest deadline. It is the only job in the
+ * running band, every other ready job stays parked below it, so EDF order is
+ * kept for any number of tasks. Under SRP a job that has not started yet is
+ * only dispatched if its preemption level is above the system ceiling. Must be
+ * called inside a critical section. */
+static void prvUpdateEDFPriorities(BaseType_t xApplyToTasks)
+{
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	SchedTCB_t *pxEarliest = prvSRPEarliestEligible();
+#else
+	SchedTCB_t *pxEarliest = (uxEDFHeapSize > 0) ? pxEDFHeap[0] : NULL;
+#endif /* schedSUB_SCHEDULING_POLICY */
+	SchedTCB_t *pxPrevious;
+
+	xEDFOrderChanged = pdFALSE;
+
+	if (pxEarliest == pxEDFRunningTask)
+	{
+		return;
+	}
+
+	/* Either change of priority may switch tasks, so the new running task is
+	 * recorded first. */
+	pxPrevious = pxEDFRunningTask;
+	pxEDFRunningTask = pxEarliest;
+	if (NULL != pxPrevious)
+	{
+		prvEDFSetPriority(pxPrevious, schedEDF_PARKED_PRIORITY, xApplyToTasks);
+	}
+	if (NULL != pxEarliest)
+	{
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+		pxEarliest->xJobStarted = pdTRUE;
+#endif /* schedSUB_SCHEDULING_POLICY */
+		prvEDFSetPriority(pxEarliest, schedEDF_RUNNING_PRIORITY, xApplyToTasks);
+	}
+}
+#else
+/* Assigns EDF priorities from the deadline heap. Only the first
+ * schedEDF_RANKED_TASKS jobs need distinct levels, so they are pulled out of
+ * the heap in deadline order by expanding a small set of candidate nodes
+ * starting at the root. The cost depends on the number of priority levels,
+ * not on the number of tasks. If xApplyToTasks is pdTRUE the kernel priorities
+ * of tasks whose priority changed are updated as well. */
+static void prvUpdateEDFPriorities(BaseType_t xApplyToTasks)
+{
+	SchedTCB_t *pxPreviousRanked[schedEDF_RANKED_TASKS];
+	UBaseType_t uxPreviousCount = uxEDFRankedCount;
+	UBaseType_t uxCandidates[schedEDF_RANKED_TASKS + 1];
+	UBaseType_t uxCandidateCount = 0;
+	UBaseType_t uxRank, uxIter, uxEarliest, uxHeapIndex;
+	SchedTCB_t *pxTCB;
+
+	if (pdFALSE == xEDFOrderChanged)
+	{
+		return;
+	}
+	xEDFOrderChanged = pdFALSE;
+
+	/* Forget the previous ranking. Tasks which are not ranked again fall back to priority 0. */
+	for (uxRank = 0; uxRank < uxPreviousCount; uxRank++)
+	{
+		pxPreviousRanked[uxRank] = pxEDFRankedTasks[uxRank];
+		pxPreviousRanked[uxRank]->xPriorityIsSet = pdFALSE;
+	}
+
+	if (uxEDFHeapSize > 0)
+	{
+		uxCandidates[uxCandidateCount++] = 0;
+	}
+
+	for (uxRank = 0; uxRank < schedEDF_RANKED_TASKS && uxCandidateCount > 0; uxRank++)
+	{
+		/* The next earliest deadline is always one of the candidates. */
+		uxEarliest = 0;
+		for (uxIter = 1; uxIter < uxCandidateCount; uxIter++)
+		{
+			if (pdTRUE == prvEDFDeadlineBefore(pxEDFHeap[uxCandidates[uxIter]], pxEDFHeap[uxCandidates[uxEarliest]]))
+			{
+				uxEarliest = uxIter;
+			}
+		}
+		uxHeapIndex = uxCandidates[uxEarliest];
+		uxCandidates[uxEarliest] = uxCandidates[--uxCandidateCount];
+
+		if (2 * uxHeapIndex + 1 < uxEDFHeapSize)
+		{
+			uxCandidates[uxCandidateCount++] = 2 * uxHeapIndex + 1;
+		}
+		if (2 * uxHeapIndex + 2 < uxEDFHeapSize)
+		{
+			uxCandidates[uxCandidateCount++] = 2 * uxHeapIndex + 2;
+		}
+
+		pxTCB = pxEDFHeap[uxHeapIndex];
+		pxTCB->xPriorityIsSet = pdTRUE;
+		pxEDFRankedTasks[uxRank] = pxTCB;
+	}
+
+	uxEDFRankedCount = uxRank;
+
+	/* Demote tasks that dropped out of the ranking. */
+	for (uxIter = 0; uxIter < uxPreviousCount; uxIter++)
+	{
+		pxTCB = pxPreviousRanked[uxIter];
+		if (pdFALSE == pxTCB->xPriorityIsSet)
+		{
+			prvEDFSetPriority(pxTCB, tskIDLE_PRIORITY, xApplyToTasks);
+		}
+	}
+
+	for (uxRank = 0; uxRank < uxEDFRankedCount; uxRank++)
+	{
+		prvEDFSetPriority(pxEDFRankedTasks[uxRank], schedEDF_HIGHEST_TASK_PRIORITY - uxRank, xApplyToTasks);
+	}
+
+#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
+	/* The ceilings follow the ranks, which change with every release, and a
+	 * task that holds resources moves to their new ceilings at once. */
+	prvComputePriorityCeilings();
+	for (uxIter = 0; uxIter < schedMAX_NUMBER_OF_PERIODIC_TASKS && pdTRUE == xApplyToTasks; uxIter++)
+	{
+		pxTCB = &xTCBArray[uxIter];
+		if (pdTRUE == pxTCB->xInUse && 0 != pxTCB->uxHeldCount)
+		{
+			vTaskPrioritySet(*pxTCB->pxTaskHandle, prvHeldPriority(pxTCB));
+		}
+	}
+#endif /* schedSUB_SCHEDULING_POLICY */
+}
+#endif /* schedUSE_EDF_PRIORITY_BANDS */
+#endif /* schedSCHEDULING_POLICY */
+
+#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
+/* Sets the priority ceiling of every resource, the highest priority of the
+ * tasks that use it, in a single pass over the resource lists of the tasks.
+ * Must be called inside a critical section. */
+static void prvComputePriorityCeilings(void)
+{
+	BaseType_t xIter, xIndex;
+	UBaseType_t uxUse;
+	SchedTCB_t *pxTCB;
+	SchedRCB_t *pxRCB;
+
+	for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
+	{
+		xRCBArray[xIter].priorityCeiling = 0;
+	}
 
-	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
 	{
-		xShortest = portMAX_DELAY;
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse)
+		{
+			continue;
+		}
 
-		/* search for shortest period */
-		for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+		for (uxUse = 0; uxUse < pxTCB->uxResourceUseCount; uxUse++)
 		{
-			/* your implementation goes here */
-			if (xTCBArray[xIndex].xInUse == pdFALSE)
-				continue;
-			if (xTCBArray[xIndex].xPriorityIsSet == pdTRUE)
-				continue;
+			pxRCB = &xRCBArray[pxTCB->xResourceUse[uxUse].xResourceIndex];
 
-#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS)
-			/* your implementation goes here */
-			if (xShortest > xTCBArray[xIndex].xPeriod)
+			if (pxRCB->priorityCeiling < (BaseType_t)pxTCB->uxPriority)
 			{
-				xShortest = xTCBArray[xIndex].xPeriod;
-				pxShortestTaskPointer = &xTCBArray[xIndex];
-			}
-#endif /* schedSCHEDULING_POLICY */
-#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DMS)
-			if (xShortest > xTCBArray[xIndex].xRelativeDeadline)
-			{
-				xShortest = xTCBArray[xIndex].xRelativeDeadline;
-				pxShortestTaskPointer = &xTCBArray[xIndex];
+				pxRCB->priorityCeiling = pxTCB->uxPriority;
 			}
-#endif /* schedSCHEDULING_POLICY */
 		}
+	}
 
-		/* set highest priority to task with xShortest period (the highest priority is configMAX_PRIORITIES-1) */
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+	/* A task admitted at run time can change the ceiling of a resource in use. */
+	prvOPCPRebuildSystemCeiling();
+#endif /* schedSUB_SCHEDULING_POLICY */
+}
 
-		/* your implementation goes here */
+#if (schedUSE_FIXED_PRIORITIES)
+/* Sets and prints the priority ceilings of all resources. Ranked EDF sets the
+ * ceilings with every new ranking, see prvUpdateEDFPriorities. */
+static void prvSetPriorityCeilings(void)
+{
+	taskENTER_CRITICAL();
+	prvComputePriorityCeilings();
+	taskEXIT_CRITICAL();
 
-		if (xHighestPriority > 0)
-		{
-			xHighestPriority--;
-		}
-		else
-		{
-			xHighestPriority = 0;
-		}
+	prvPrintPriorityCeilings();
+}
 
-		configASSERT(0 <= xHighestPriority);
-		pxShortestTaskPointer->uxPriority = xHighestPriority;
-		pxShortestTaskPointer->uxBasePriority = pxShortestTaskPointer->uxPriority;
-		pxShortestTaskPointer->xPriorityIsSet = pdTRUE;
-		xPreviousShortest = xShortest;
+/* Prints the priority ceilings of all resources. */
+static void prvPrintPriorityCeilings(void)
+{
+	BaseType_t xIter;
 
-		Serial.print(pxShortestTaskPointer->pcName);
-		Serial.print(" has priority ");
-		Serial.println(pxShortestTaskPointer->uxPriority);
-		// Serial.flush();
+	for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
+	{
+		Serial.print("R");
+		Serial.print(xIter + 1);
+		Serial.print(" priority ceiling - ");
+		Serial.println(xRCBArray[xIter].priorityCeiling);
 	}
+	// Serial.flush();
 }
 #endif /* schedSCHEDULING_POLICY */
-
-#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
-static void prvSetEDFInitialPriorities(void)
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+/* Sets the preemption ceiling of every resource. Preemption levels follow the
+ * relative deadlines, a shorter deadline is a higher level, so the ceiling of
+ * a resource is the shortest relative deadline of the tasks that use it. Must
+ * be called inside a critical section once the scheduler runs. */
+static void prvSetPreemptionCeilings(void)
 {
 	BaseType_t xIter, xIndex;
-	TickType_t xShortest, xPreviousShortest = 0;
-	SchedTCB_t *pxShortestTaskPointer;
-
-#if (schedUSE_SCHEDULER_TASK == 1)
-	BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY;
-#else
-	BaseType_t xHighestPriority = configMAX_PRIORITIES;
-#endif /* schedUSE_SCHEDULER_TASK */
+	UBaseType_t uxUse;
+	SchedTCB_t *pxTCB;
+	SchedRCB_t *pxRCB;
 
-	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
 	{
-		xShortest = portMAX_DELAY;
+		xRCBArray[xIter].xPreemptionCeiling = portMAX_DELAY;
+	}
 
-		/* search for shortest period */
-		for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+	for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
+	{
+		pxTCB = &xTCBArray[xIndex];
+		if (pdFALSE == pxTCB->xInUse)
 		{
-			/* your implementation goes here */
-			if (xTCBArray[xIndex].xInUse == pdFALSE)
-				continue;
-			if (xTCBArray[xIndex].xPriorityIsSet == pdTRUE)
-				continue;
+			continue;
+		}
 
-			if (xShortest > xTCBArray[xIndex].xRelativeDeadline)
+		for (uxUse = 0; uxUse < pxTCB->uxResourceUseCount; uxUse++)
+		{
+			pxRCB = &xRCBArray[pxTCB->xResourceUse[uxUse].xResourceIndex];
+			if (pxTCB->xRelativeDeadline < pxRCB->xPreemptionCeiling)
 			{
-				xShortest = xTCBArray[xIndex].xRelativeDeadline;
-				pxShortestTaskPointer = &xTCBArray[xIndex];
+				pxRCB->xPreemptionCeiling = pxTCB->xRelativeDeadline;
 			}
 		}
+	}
 
-		/* set highest priority to task with xShortest period (the highest priority is configMAX_PRIORITIES-1) */
+	prvSRPUpdateSystemCeiling();
+}
 
-		/* your implementation goes here */
+/* Recomputes the system ceiling from the resources in use. Must be called
+ * inside a critical section. */
+static void prvSRPUpdateSystemCeiling(void)
+{
+	BaseType_t xIter;
 
-		if (xHighestPriority > 0)
-		{
-			xHighestPriority--;
-		}
-		else
+	xSRPSystemCeiling = portMAX_DELAY;
+	for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
+	{
+		if (pdTRUE == xRCBArray[xIter].xInUse && xRCBArray[xIter].xPreemptionCeiling < xSRPSystemCeiling)
 		{
-			xHighestPriority = 0;
+			xSRPSystemCeiling = xRCBArray[xIter].xPreemptionCeiling;
 		}
-
-		configASSERT(0 <= xHighestPriority);
-		pxShortestTaskPointer->uxPriority = xHighestPriority;
-		pxShortestTaskPointer->uxBasePriority = pxShortestTaskPointer->uxPriority;
-		pxShortestTaskPointer->xPriorityIsSet = pdTRUE;
-		xPreviousShortest = xShortest;
-
-		Serial.print(pxShortestTaskPointer->pcName);
-		Serial.print(" has priority ");
-		Serial.println(pxShortestTaskPointer->uxPriority);
-		// Serial.flush();
 	}
 }
 
-static void prvUpdateEDFPriorities(TickType_t xTickCount)
+/* Returns the job with the earliest deadline that may run: one that has
+ * already started, or one whose preemption level is above the system ceiling.
+ * The heap is searched from the root, and the subtree below an eligible job is
+ * skipped because it holds no earlier deadline. Must be called inside a
+ * critical section. */
+static SchedTCB_t *prvSRPEarliestEligible(void)
 {
-	BaseType_t xIter, xIndex;
-	TickType_t xShortestTimeLeft, xPreviousShortest = 0;
-	SchedTCB_t *pxShortestTaskPointer;
+	UBaseType_t uxPending[schedMAX_NUMBER_OF_PERIODIC_TASKS];
+	UBaseType_t uxPendingCount = 0, uxIndex;
+	SchedTCB_t *pxEarliest = NULL, *pxTCB;
 
-#if (schedUSE_SCHEDULER_TASK == 1)
-	BaseType_t xHighestPriority = schedSCHEDULER_PRIORITY;
-#else
-	BaseType_t xHighestPriority = configMAX_PRIORITIES;
-#endif /* schedUSE_SCHEDULER_TASK */
-
-	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	if (uxEDFHeapSize > 0)
 	{
-		xTCBArray[xIter].xPriorityIsSet = pdFALSE;
+		uxPending[uxPendingCount++] = 0;
 	}
 
-	for (xIter = 0; xIter < xTaskCounter; xIter++)
+	while (uxPendingCount > 0)
 	{
-		xShortestTimeLeft = portMAX_DELAY;
+		uxIndex = uxPending[--uxPendingCount];
+		pxTCB = pxEDFHeap[uxIndex];
 
-		/* search for shortest period */
-		for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+		if (NULL != pxEarliest && pdFALSE == prvEDFDeadlineBefore(pxTCB, pxEarliest))
 		{
-			/* your implementation goes here */
-			if (xTCBArray[xIndex].xInUse == pdFALSE)
-				continue;
-			if (xTCBArray[xIndex].xPriorityIsSet == pdTRUE)
-				continue;
-
-			if (xShortestTimeLeft > xTCBArray[xIndex].xAbsoluteDeadline)
-			{
-				xShortestTimeLeft = xTCBArray[xIndex].xAbsoluteDeadline;
-				pxShortestTaskPointer = &xTCBArray[xIndex];
-			}
+			continue;
+		}
+		if (pdTRUE == pxTCB->xJobStarted || pxTCB->xRelativeDeadline < xSRPSystemCeiling)
+		{
+			pxEarliest = pxTCB;
+			continue;
 		}
 
-		/* set highest priority to task with xShortest period (the highest priority is configMAX_PRIORITIES-1) */
-
-		/* your implementation goes here */
-		if (xHighestPriority > 0)
+		/* Every heap entry is added at most once. */
+		if (2 * uxIndex + 1 < uxEDFHeapSize)
 		{
-			xHighestPriority--;
+			uxPending[uxPendingCount++] = 2 * uxIndex + 1;
 		}
-		else
+		if (2 * uxIndex + 2 < uxEDFHeapSize)
 		{
-			xHighestPriority = 0;
+			uxPending[uxPendingCount++] = 2 * uxIndex + 2;
 		}
-
-		configASSERT(0 <= xHighestPriority);
-		pxShortestTaskPointer->uxPriority = xHighestPriority;
-		pxShortestTaskPointer->uxBasePriority = pxShortestTaskPointer->uxPriority;
-		pxShortestTaskPointer->xPriorityIsSet = pdTRUE;
-		xPreviousShortest = xShortestTimeLeft;
-
-		vTaskPrioritySet(*pxShortestTaskPointer->pxTaskHandle, pxShortestTaskPointer->uxPriority);
-
-		// Serial.print(pxShortestTaskPointer->pcName);
-		// Serial.print(" ");
-		// Serial.print(xShortestTimeLeft);
-		// Serial.print(" ");
-		// Serial.println(pxShortestTaskPointer->uxPriority);
 	}
+
+	return pxEarliest;
 }
-#endif /* schedSCHEDULING_POLICY */
+#endif /* schedSUB_SCHEDULING_POLICY */
 
-#if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
-static void prvSetPriorityCeilings(void)
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
+/* Gives back all resources held by a task whose job is being aborted or
+ * stopped, innermost first, so that tasks waiting for them are not blocked
+ * forever. Called by the scheduler task inside a critical section; semaphores
+ * cannot be given from the tick hook. Priorities are left to the caller. */
+static void prvReleaseHeldResources(SchedTCB_t *pxTCB)
 {
-	BaseType_t xIter, xIndex;
-	SchedTCB_t *pxTCB;
 	SchedRCB_t *pxRCB;
 
-	prvInitRCBArray();
-
-	for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+	while (pxTCB->uxHeldCount > 0)
 	{
-		pxTCB = &xTCBArray[xIndex];
-		configASSERT(pdTRUE == pxTCB->xInUse);
-
-		for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
+		pxTCB->uxHeldCount--;
+		pxRCB = &xRCBArray[pxTCB->xHeldResource[pxTCB->uxHeldCount]];
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP || schedUSE_IPCP_FAST_PATH == 1)
+		pxRCB->xInUse = pdFALSE;
+		pxRCB->xMutexHolder = NULL;
+#else
+		if (pdTRUE == xSemaphoreGive(pxRCB->xMutexSem))
 		{
-			if (pxTCB->xRTickArray[xIter] > 0)
-			{
-				pxRCB = &xRCBArray[xIter];
-
-				if (pxRCB->priorityCeiling < pxTCB->uxPriority)
-				{
-					pxRCB->priorityCeiling = pxTCB->uxPriority;
-				}
-			}
+			pxRCB->xInUse = pdFALSE;
+			pxRCB->xMutexHolder = NULL;
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+			prvOPCPUnlock(pxRCB);
+#endif /* schedSUB_SCHEDULING_POLICY */
 		}
+#endif /* schedSUB_SCHEDULING_POLICY */
 	}
+	pxTCB->xBlocked = pdFALSE;
 
-	Serial.print("R1 priority ceiling - ");
-	Serial.println(xRCBArray[0].priorityCeiling);
-	Serial.print("R2 priority ceiling - ");
-	Serial.println(xRCBArray[1].priorityCeiling);
-	// Serial.flush();
-}
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	/* The caller dispatches again once the job is gone. */
+	prvSRPUpdateSystemCeiling();
 #endif /* schedSUB_SCHEDULING_POLICY */
+}
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
 #if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
-/* Recreates a deleted task that still has its information left in the task array (or list). */
+/* Recreates a deleted task that still has its information left in the task array (or list).
+ * With schedUSE_STATIC_ALLOCATION the task is rebuilt on the stack and kernel TCB
+ * memory of its slot, so recovery never touches the heap and cannot fail. */
 static void prvPeriodicTaskRecreate(SchedTCB_t *pxTCB)
 {
-	BaseType_t xReturnValue = xTaskCreate((TaskFunction_t)prvPeriodicTaskCode,
-										  pxTCB->pcName,
-										  pxTCB->uxStackDepth,
-										  pxTCB->pvParameters, pxTCB->uxPriority,
-										  pxTCB->pxTaskHandle);
+	BaseType_t xReturnValue = prvCreateKernelTask(pxTCB);
 
 	if (pdPASS == xReturnValue)
 	{
 		/* your implementation goes here */
 		pxTCB->xExecutedOnce = pdFALSE;
-		pxTCB->xSuspended = pdFALSE;
+		pxTCB->xDeadlineMissed = pdFALSE;
+		pxTCB->xDegraded = pdFALSE;
 		pxTCB->xWorkIsDone = pdFALSE;
+#if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
+		pxTCB->xSuspended = pdFALSE;
 		pxTCB->xMaxExecTimeExceeded = pdFALSE;
+#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
+#if (schedUSE_TRACE == 1)
+		prvTrace(schedTRACE_TASK_RECREATED, pxTCB, 0);
+#else
 		Serial.print(pxTCB->pcName);
 		Serial.println(" task recreated");
 		// Serial.flush();
+#endif /* schedUSE_TRACE */
 	}
 	else
 	{
@@ -623,24 +2446,60 @@ static void prvPeriodicTaskRecreate(SchedTCB_t *pxTCB)
 }
 
 /* Called when a deadline of a periodic task is missed.
- * Deletes the periodic task that has missed it's deadline and recreate it.
- * The periodic task is released during next period. */
+ * With schedDEADLINE_MISS_ABORT the periodic task that has missed it's deadline
+ * is deleted and recreated, and released during next period. With the other
+ * policies the job is marked late and finishes, the policy is applied by the
+ * task itself when the job completes. */
 static void prvDeadlineMissedHook(SchedTCB_t *pxTCB, TickType_t xTickCount)
 {
+#if (schedUSE_TRACE == 1)
+	prvTrace(schedTRACE_DEADLINE_MISS, pxTCB, 0);
+#else
 	Serial.print(pxTCB->pcName);
 	Serial.println(" task deadline missed");
 	// Serial.flush();
+#endif /* schedUSE_TRACE */
+
+	if (schedDEADLINE_MISS_ABORT != pxTCB->xMissPolicy)
+	{
+		pxTCB->xDeadlineMissed = pdTRUE;
+		return;
+	}
+
+	/* The aborted job must not keep its resources. */
+	taskENTER_CRITICAL();
+	prvReleaseHeldResources(pxTCB);
+	taskEXIT_CRITICAL();
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF && schedUSE_EDF_PRIORITY_BANDS == 1)
+	/* The recreated task starts in the release band. */
+	taskENTER_CRITICAL();
+	prvEDFJobNotReady(pxTCB, schedEDF_RELEASE_PRIORITY);
+	taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY && schedUSE_EDF_PRIORITY_BANDS */
 
-	/* Delete the pxTask and recreate it. */
+	/* Delete the pxTask and recreate it. The task is not running, so the kernel
+	 * drops it at once instead of leaving its memory to the idle task. */
 	vTaskDelete(*pxTCB->pxTaskHandle);
+#if (schedUSE_SHARED_STACK == 1)
+	/* The job ran on the worker of its level, which is recreated for all of
+	 * its tasks. */
+	pxTCB->pxLevel->xWorkerHandle = NULL;
+#endif /* schedUSE_SHARED_STACK */
+	pxTCB->xExecStart = pdFALSE;
 	pxTCB->xExecTime = 0;
 	prvPeriodicTaskRecreate(pxTCB);
 
 	/* Need to reset next WakeTime for correct release. */
 	/* your implementation goes here */
-	pxTCB->xReleaseTime = pxTCB->xLastWakeTime + pxTCB->xPeriod;
-	pxTCB->xLastWakeTime = 0;
-	pxTCB->xAbsoluteDeadline = pxTCB->xRelativeDeadline + pxTCB->xReleaseTime;
+	pxTCB->xReleaseTime = pxTCB->xPeriod;
+	pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xPeriod + pxTCB->xRelativeDeadline;
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	taskENTER_CRITICAL();
+	prvEDFDeadlineChanged(pxTCB);
+	taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY */
 }
 
 /* Checks whether given task has missed deadline or not. */
@@ -650,8 +2509,19 @@ static void prvCheckDeadline(SchedTCB_t *pxTCB, TickType_t xTickCount)
 	/* your implementation goes here */
 	if ((pxTCB->xExecutedOnce == pdTRUE) && (pxTCB->xWorkIsDone == pdFALSE))
 	{
-		pxTCB->xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
-		if (pxTCB->xAbsoluteDeadline < xTickCount)
+		TickType_t xAbsoluteDeadline = pxTCB->xLastWakeTime + pxTCB->xRelativeDeadline;
+
+		if (pxTCB->xAbsoluteDeadline != xAbsoluteDeadline)
+		{
+			pxTCB->xAbsoluteDeadline = xAbsoluteDeadline;
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+			taskENTER_CRITICAL();
+			prvEDFDeadlineChanged(pxTCB);
+			taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY */
+		}
+
+		if (pdFALSE == pxTCB->xDeadlineMissed && schedTIME_BEFORE(pxTCB->xAbsoluteDeadline, xTickCount))
 		{
 			prvDeadlineMissedHook(pxTCB, xTickCount);
 		}
@@ -663,40 +2533,92 @@ static void prvCheckDeadline(SchedTCB_t *pxTCB, TickType_t xTickCount)
 
 /* Called if a periodic task has exceeded its worst-case execution time.
  * The periodic task is blocked until next period. A context switch to
- * the scheduler task occur to block the periodic task. */
-static void prvExecTimeExceedHook(TickType_t xTickCount, SchedTCB_t *pxCurrentTask)
+ * the scheduler task occur to block the periodic task. Returns pdTRUE if the
+ * interrupt must switch to the scheduler task. */
+static BaseType_t prvExecTimeExceedHook(TickType_t xTickCount, SchedTCB_t *pxCurrentTask)
 {
-	Serial.print(pxCurrentTask->pcName);
-	Serial.println(" exec time exceeded ");
-	Serial.flush();
-
-	// Release any accessed resources
-	if (pxCurrentTask->xResourceAccessed == pdTRUE)
-	{
-		SchedRCB_t *pxRCB = &xRCBArray[pxCurrentTask->xResourceIndex];
-		BaseType_t status = xSemaphoreGive(pxRCB->xMutexSem);
-
-		if (status == pdTRUE)
-		{
-			pxRCB->xInUse = pdFALSE;
-			pxCurrentTask->xBlocked = pdFALSE;
-			pxCurrentTask->xResourceAccessed = pdFALSE;
-		}
-	}
+#if (schedUSE_TRACE == 1)
+	prvTraceRecord(schedTRACE_EXEC_TIME_EXCEEDED, pxCurrentTask, 0);
+#endif /* schedUSE_TRACE */
 
+	/* The scheduler task reports the overrun and gives back the held resources
+	 * before it suspends the task. Serial must not be written from the tick
+	 * interrupt. */
 	pxCurrentTask->xMaxExecTimeExceeded = pdTRUE;
 	/* Is not suspended yet, but will be suspended by the scheduler later. */
 	pxCurrentTask->xSuspended = pdTRUE;
 	pxCurrentTask->xAbsoluteUnblockTime = pxCurrentTask->xLastWakeTime + pxCurrentTask->xPeriod;
 	pxCurrentTask->xExecTime = 0;
+	pxCurrentTask->xSwitchInTime = schedEXEC_TIME_NOW();
 
-	BaseType_t xHigherPriorityTaskWoken;
+	BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 	vTaskNotifyGiveFromISR(xSchedulerHandle, &xHigherPriorityTaskWoken);
-	xTaskResumeFromISR(xSchedulerHandle);
+	if (pdFALSE != xTaskResumeFromISR(xSchedulerHandle))
+	{
+		xHigherPriorityTaskWoken = pdTRUE;
+	}
+	return xHigherPriorityTaskWoken;
+}
+
+/* Called from the tick hook and the budget timer interrupt. Stops the job of
+ * pxCurrentTask if it has exceeded its budget. A job that has completed or is
+ * already stopped is left alone, as is one that was switched in after the
+ * interrupt was raised for another job. Returns pdTRUE if the interrupt must
+ * switch to the scheduler task. */
+static BaseType_t prvCheckExecTimeFromISR(SchedTCB_t *pxCurrentTask)
+{
+	if (NULL != pxCurrentTask && pdTRUE == pxCurrentTask->xExecStart)
+	{
+		SchedExecTime_t xNow = schedEXEC_TIME_NOW();
+
+		if (pxCurrentTask->xMaxExecTime < pxCurrentTask->xExecTime + (SchedExecTime_t)(xNow - pxCurrentTask->xSwitchInTime)) // DEBUG - SUNIL Changed from <= to <
+		{
+			if (pdFALSE == pxCurrentTask->xMaxExecTimeExceeded)
+			{
+				if (pdFALSE == pxCurrentTask->xSuspended)
+				{
+					return prvExecTimeExceedHook(xTaskGetTickCountFromISR(), pxCurrentTask);
+				}
+			}
+		}
+	}
+	return pdFALSE;
 }
 #endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
+#if (schedUSE_BUDGET_TIMER == 1)
+/* Arms the budget timer for the rest of the budget of the job of pxTCB, which
+ * is running and has just set xSwitchInTime. Must be called with interrupts
+ * disabled. */
+static void prvBudgetTimerArm(SchedTCB_t *pxTCB)
+{
+	SchedExecTime_t xLeft = 0;
+
+	if (pdTRUE != pxTCB->xExecStart || pdFALSE != pxTCB->xMaxExecTimeExceeded || pdFALSE != pxTCB->xSuspended)
+	{
+		prvBudgetTimerStop();
+		return;
+	}
+	if (pxTCB->xExecTime < pxTCB->xMaxExecTime)
+	{
+		xLeft = pxTCB->xMaxExecTime - pxTCB->xExecTime;
+	}
+	/* The budget is exceeded one counter step after it is used up, as in the
+	 * check of the tick hook. */
+	prvBudgetTimerStart(xLeft / schedRUN_TIME_COUNTER_PERIOD_US + 1);
+}
+
+/* Called from the budget timer interrupt. The scheduler task stops the job. */
+static void prvBudgetTimerExpired(void)
+{
+	BaseType_t xSwitchRequired = prvCheckExecTimeFromISR(pxCurrentSchedTCB);
+
+	schedYIELD_FROM_ISR(xSwitchRequired);
+}
+#endif /* schedUSE_BUDGET_TIMER */
+
 #if (schedUSE_SCHEDULER_TASK == 1)
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
 /* Called by the scheduler task. Checks all tasks for any enabled
  * Timing Error Detection feature. */
 static void prvSchedulerCheckTimingError(TickType_t xTickCount, SchedTCB_t *pxTCB)
@@ -713,57 +2635,109 @@ static void prvSchedulerCheckTimingError(TickType_t xTickCount, SchedTCB_t *pxTC
 	if (pdTRUE == pxTCB->xMaxExecTimeExceeded)
 	{
 		pxTCB->xMaxExecTimeExceeded = pdFALSE;
+#if (schedUSE_TRACE == 0)
+		Serial.print(pxTCB->pcName);
+		Serial.println(" exec time exceeded ");
+#endif /* schedUSE_TRACE */
+
+		/* The stopped job must not keep its resources. The task is not
+		 * running, the scheduler task preempted it. */
+		taskENTER_CRITICAL();
+		prvReleaseHeldResources(pxTCB);
+		taskEXIT_CRITICAL();
+
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF && schedUSE_EDF_PRIORITY_BANDS == 1)
+		taskENTER_CRITICAL();
+		prvEDFJobNotReady(pxTCB, pxTCB->uxPriority);
+		taskEXIT_CRITICAL();
+#elif ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP))
+		/* Drop the priority the released resources raised. */
+		vTaskPrioritySet(*pxTCB->pxTaskHandle, pxTCB->uxBasePriority);
+#endif /* schedSCHEDULING_POLICY && schedUSE_EDF_PRIORITY_BANDS */
 		vTaskSuspend(*pxTCB->pxTaskHandle);
 	}
 	if (pdTRUE == pxTCB->xSuspended)
 	{
-		if ((signed)(pxTCB->xAbsoluteUnblockTime - xTickCount) <= 0)
+		if (!schedTIME_BEFORE(xTickCount, pxTCB->xAbsoluteUnblockTime))
 		{
 			pxTCB->xSuspended = pdFALSE;
 			pxTCB->xLastWakeTime = xTickCount;
+#if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF && schedUSE_EDF_PRIORITY_BANDS == 1)
+			taskENTER_CRITICAL();
+			pxTCB->xAbsoluteDeadline = xTickCount + pxTCB->xRelativeDeadline;
+			prvEDFJobReady(pxTCB);
+			taskEXIT_CRITICAL();
+#endif /* schedSCHEDULING_POLICY && schedUSE_EDF_PRIORITY_BANDS */
 			vTaskResume(*pxTCB->pxTaskHandle);
 		}
 	}
 #endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1)
+	taskENTER_CRITICAL();
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
+	if ((pxTCB->xExecutedOnce == pdTRUE) && (pxTCB->xWorkIsDone == pdFALSE) && (pxTCB->xDeadlineMissed == pdFALSE))
+	{
+		prvSchedulerWakeAt(pxTCB->xAbsoluteDeadline + 1);
+	}
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+#if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
+	if (pdTRUE == pxTCB->xSuspended)
+	{
+		prvSchedulerWakeAt(pxTCB->xAbsoluteUnblockTime);
+	}
+#endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+	taskEXIT_CRITICAL();
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER */
+
 	return;
 }
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
 /* Function code for the scheduler task. */
 static void prvSchedulerFunction(void *pvParameters)
 {
 	BaseType_t xIndex = 0;
+	SchedTCB_t *pxTCB;
 
 	for (;;)
 	{
 		taskENTER_CRITICAL();
 
-		TickType_t xTickCount = xTaskGetTickCount();
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1)
+		/* The timed events still pending are collected again below. */
+		xSchedulerWakeArmed = pdFALSE;
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER */
 
 #if (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
 		{
-			prvUpdateEDFPriorities(xTickCount);
+			prvUpdateEDFPriorities(pdTRUE);
 		}
 #endif /* schedSCHEDULING_POLICY */
 
 		taskEXIT_CRITICAL();
 
 #if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
-		// TickType_t xTickCount = xTaskGetTickCount();
-		SchedTCB_t *pxTCB;
+		TickType_t xTickCount = xTaskGetTickCount();
+#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
 
 		/* your implementation goes here. */
-		for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+		for (xIndex = 0; xIndex < schedMAX_NUMBER_OF_PERIODIC_TASKS; xIndex++)
 		{
 			pxTCB = &xTCBArray[xIndex];
 
-			if (pxTCB->xInUse == pdTRUE)
+			if (pxTCB->xInUse == pdTRUE && pxTCB->xDeletePending == pdTRUE)
+			{
+				/* The task has suspended itself in vSchedulerPeriodicTaskDelete. */
+				prvPeriodicTaskRemove(pxTCB);
+			}
+#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
+			else if (pxTCB->xInUse == pdTRUE)
 			{
 				prvSchedulerCheckTimingError(xTickCount, pxTCB);
 			}
-		}
-
 #endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
+		}
 
 		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 	}
@@ -772,7 +2746,11 @@ static void prvSchedulerFunction(void *pvParameters)
 /* Creates the scheduler task. */
 static void prvCreateSchedulerTask(void)
 {
+#if (schedUSE_STATIC_ALLOCATION == 1)
+	xSchedulerHandle = xTaskCreateStatic((TaskFunction_t)prvSchedulerFunction, "Scheduler", schedSCHEDULER_TASK_STACK_SIZE, NULL, schedSCHEDULER_PRIORITY, uxSchedulerStack, &xSchedulerTaskBuffer);
+#else
 	xTaskCreate((TaskFunction_t)prvSchedulerFunction, "Scheduler", schedSCHEDULER_TASK_STACK_SIZE, NULL, schedSCHEDULER_PRIORITY, &xSchedulerHandle);
+#endif /* schedUSE_STATIC_ALLOCATION */
 }
 #endif /* schedUSE_SCHEDULER_TASK */
 
@@ -785,132 +2763,132 @@ static void prvWakeScheduler(void)
 	xTaskResumeFromISR(xSchedulerHandle);
 }
 
-/* Called every software tick. */
-// In FreeRTOSConfig.h,
-// Enable configUSE_TICK_HOOK
-// Enable INCLUDE_xTaskGetIdleTaskHandle
-// Enable INCLUDE_xTaskGetCurrentTaskHandle
-void vApplicationTickHook(void)
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1 && (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1 || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1))
+/* Makes the tick hook wake the scheduler task at xWakeTime, unless an earlier
+ * wake up is already pending. Must be called inside a critical section. */
+static void prvSchedulerWakeAt(TickType_t xWakeTime)
 {
-	SchedTCB_t *pxCurrentTask;
-	TaskHandle_t xCurrentTaskHandle = xTaskGetCurrentTaskHandle();
-	UBaseType_t flag = 0;
-	BaseType_t xIndex;
-	BaseType_t prioCurrentTask = uxTaskPriorityGet(xCurrentTaskHandle);
-
-	for (xIndex = 0; xIndex < xTaskCounter; xIndex++)
+	if (pdFALSE == xSchedulerWakeArmed || schedTIME_BEFORE(xWakeTime, xSchedulerNextWakeTime))
 	{
-		pxCurrentTask = &xTCBArray[xIndex];
-		if ((pxCurrentTask->uxPriority == prioCurrentTask) && (pxCurrentTask->xBlocked == pdFALSE) && (pxCurrentTask->xExecStart == pdTRUE))
-		{
-			flag = 1;
-			break;
-		}
+		xSchedulerNextWakeTime = xWakeTime;
+		xSchedulerWakeArmed = pdTRUE;
 	}
+}
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER && (schedUSE_TIMING_ERROR_DETECTION_DEADLINE || schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME) */
 
-	if (xCurrentTaskHandle != xSchedulerHandle && xCurrentTaskHandle != xTaskGetIdleTaskHandle() && flag == 1)
-	{
-		pxCurrentTask->xExecTime++;
-
+/* Called every software tick. Execution time is accounted on context
+ * switches, so only the budget of the running task is checked here. */
+// In FreeRTOSConfig.h,
+// Enable configUSE_TICK_HOOK
+// Enable configUSE_APPLICATION_TASK_TAG
+// Define traceTASK_SWITCHED_IN and traceTASK_SWITCHED_OUT
+void vApplicationTickHook(void)
+{
 #if (schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME == 1)
-		if (pxCurrentTask->xMaxExecTime < pxCurrentTask->xExecTime) // DEBUG - SUNIL Changed from <= to <
-		{
-			if (pdFALSE == pxCurrentTask->xMaxExecTimeExceeded)
-			{
-				if (pdFALSE == pxCurrentTask->xSuspended)
-				{
-					prvExecTimeExceedHook(xTaskGetTickCountFromISR(), pxCurrentTask);
-				}
-			}
-		}
+	/* Also catches overruns if the budget timer is not used or could not be
+	 * created. The kernel switches to the woken scheduler task after the tick. */
+	(void)prvCheckExecTimeFromISR(pxCurrentSchedTCB);
 #endif /* schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME */
-	}
 
-#if (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1)
+	if (pdTRUE == xSchedulerWakeArmed && !schedTIME_BEFORE(xTaskGetTickCountFromISR(), xSchedulerNextWakeTime))
+	{
+		xSchedulerWakeArmed = pdFALSE;
+		prvWakeScheduler();
+	}
+#elif (schedUSE_TIMING_ERROR_DETECTION_DEADLINE == 1)
 	xSchedulerWakeCounter++;
 	if (xSchedulerWakeCounter == schedSCHEDULER_TASK_PERIOD)
 	{
 		xSchedulerWakeCounter = 0;
 		prvWakeScheduler();
 	}
-#endif /* schedUSE_TIMING_ERROR_DETECTION_DEADLINE */
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER */
+
+#if (schedUSE_TRACE == 1)
+	prvTraceWakeFromISR();
+#endif /* schedUSE_TRACE */
 }
 #endif /* schedUSE_SCHEDULER_TASK */
 
 void vRequestResource(TaskHandle_t xTaskHandle, BaseType_t xResourceIndex)
 {
-	BaseType_t xIter, status, flag = 1;
-	BaseType_t xCurrentTaskIndex = prvGetTCBIndexFromHandle(xTaskHandle);
+#if (schedSUB_SCHEDULING_POLICY != schedSUB_SCHEDULING_POLICY_SRP && schedUSE_IPCP_FAST_PATH != 1)
+	BaseType_t status;
+#endif /* schedSUB_SCHEDULING_POLICY && schedUSE_IPCP_FAST_PATH */
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP || schedUSE_IPCP_FAST_PATH == 1)
 	BaseType_t prioCurrentTask = uxTaskPriorityGet(xTaskHandle);
+#endif /* schedSUB_SCHEDULING_POLICY || schedUSE_IPCP_FAST_PATH */
 
 	SchedRCB_t *pxRCB = &xRCBArray[xResourceIndex];
-	SchedTCB_t *pxTCB = &xTCBArray[xCurrentTaskIndex];
-
-	SchedRCB_t *xBlockingResource;
+	SchedTCB_t *pxTCB = prvGetTCBFromHandle(xTaskHandle);
 
 #if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+	SchedRCB_t *xBlockingResource = NULL;
+
 	// Check if requested resource is not already blocked
+	taskENTER_CRITICAL();
 	if (pxRCB->xInUse == pdFALSE)
 	{
-		// Check if priority of current task is greater than priority ceiling of all blocked resources
-		for (xIter = 0; xIter < schedMAX_NUMBER_OF_SHARED_RESOURCES; xIter++)
-		{
-			pxRCB = &xRCBArray[xIter];
-
-			// Do not block nested resource access if other resource is held by the same task handle
-			if ((pxRCB->xInUse == pdTRUE) && (prioCurrentTask <= pxRCB->priorityCeiling) && (pxRCB->xMutexHolder != xTaskHandle))
-			{
-				xBlockingResource = pxRCB;
-				flag = 0;
-				break;
-			}
-		}
+		// Check the priority of current task against the system ceiling
+		xBlockingResource = prvOPCPBlockingResource(xTaskHandle, prioCurrentTask);
 	}
+	taskEXIT_CRITICAL();
 
-	pxRCB = &xRCBArray[xResourceIndex];
-
-	if (flag)
+	if (NULL == xBlockingResource)
 	{
 		// Grant resource access or put in blocking list
 		if (uxSemaphoreGetCount(pxRCB->xMutexSem) == 0)
 		{
+#if (schedUSE_TRACE == 1)
+			prvTrace(schedTRACE_RESOURCE_BLOCKED, pxTCB, (uint16_t)xResourceIndex);
+#else
 			Serial.print(pxTCB->pcName);
 			Serial.println(" blocked");
+#endif /* schedUSE_TRACE */
 
+			pxTCB->xBlockedResource = xResourceIndex;
 			pxTCB->xBlocked = pdTRUE;
 
-			// Get task handle of mutex holder
-			BaseType_t xMutexHolderTaskIndex = prvGetTCBIndexFromHandle(pxRCB->xMutexHolder);
-			SchedTCB_t *pxMutexHolderTCB = &xTCBArray[xMutexHolderTaskIndex];
-
-			// Set priority of mutex holder to priority of blocked task
-			if (pxMutexHolderTCB->uxPriority < pxTCB->uxPriority)
-			{
-				vTaskPrioritySet(pxRCB->xMutexHolder, pxTCB->uxPriority);
-			}
+			// Raise the mutex holder to the priority of the tasks it blocks
+			vTaskPrioritySet(pxRCB->xMutexHolder, prvHeldPriority(prvGetTCBFromHandle(pxRCB->xMutexHolder)));
 		}
 		status = xSemaphoreTake(pxRCB->xMutexSem, portMAX_DELAY);
 
 		if (status == pdTRUE)
 		{
+			taskENTER_CRITICAL();
 			pxRCB->xInUse = pdTRUE;
 			pxTCB->xBlocked = pdFALSE;
-			pxTCB->xResourceAccessed = pdTRUE;
-			pxTCB->xResourceIndex = xResourceIndex;
+			prvPushHeldResource(pxTCB, xResourceIndex);
 			pxRCB->xMutexHolder = xTaskHandle;
+			prvOPCPLock(pxRCB);
+			taskEXIT_CRITICAL();
 
+#if (schedUSE_TRACE == 1)
+			prvTrace(schedTRACE_RESOURCE_ACQUIRE, pxTCB, (uint16_t)xResourceIndex);
+#else
 			Serial.print(pxTCB->pcName);
 			Serial.print(" acquire R");
 			Serial.println(xResourceIndex + 1);
+#endif /* schedUSE_TRACE */
 		}
 	}
 	else
 	{
+#if (schedUSE_TRACE == 1)
+		prvTrace(schedTRACE_RESOURCE_BLOCKED, pxTCB, (uint16_t)(xBlockingResource - xRCBArray));
+#else
 		Serial.print(pxTCB->pcName);
 		Serial.println(" blocked");
+#endif /* schedUSE_TRACE */
 
+		pxTCB->xBlockedResource = xBlockingResource - xRCBArray;
 		pxTCB->xBlocked = pdTRUE;
 
+		// The holder of the blocking resource inherits the priority of this task
+		vTaskPrioritySet(xBlockingResource->xMutexHolder, prvHeldPriority(prvGetTCBFromHandle(xBlockingResource->xMutexHolder)));
+
 		// Wait on blocking resource
 		status = xSemaphoreTake(xBlockingResource->xMutexSem, portMAX_DELAY);
 
@@ -921,64 +2899,597 @@ void vRequestResource(TaskHandle_t xTaskHandle, BaseType_t xResourceIndex)
 			// Release blocking resource
 			xSemaphoreGive(xBlockingResource->xMutexSem);
 
+			taskENTER_CRITICAL();
 			pxRCB->xInUse = pdTRUE;
 			pxTCB->xBlocked = pdFALSE;
-			pxTCB->xResourceAccessed = pdTRUE;
-			pxTCB->xResourceIndex = xResourceIndex;
+			prvPushHeldResource(pxTCB, xResourceIndex);
 			pxRCB->xMutexHolder = xTaskHandle;
+			prvOPCPLock(pxRCB);
+			taskEXIT_CRITICAL();
 
+#if (schedUSE_TRACE == 1)
+			prvTrace(schedTRACE_RESOURCE_ACQUIRE, pxTCB, (uint16_t)xResourceIndex);
+#else
 			Serial.print(pxTCB->pcName);
 			Serial.print(" acquire R");
 			Serial.println(xResourceIndex + 1);
+#endif /* schedUSE_TRACE */
 		}
 	}
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP && schedUSE_IPCP_FAST_PATH == 1)
+	/* No other task using the resource can run while this one is below the
+	 * ceiling and ready, so the resource is free. Raising the priority of the
+	 * running task never yields; it is left alone when a resource held already
+	 * has a ceiling as high. Every task must list the resources it uses, the
+	 * ceilings are all that keeps other users out. */
+	taskENTER_CRITICAL();
+	configASSERT(pdFALSE == pxRCB->xInUse);
+	configASSERT((UBaseType_t)pxRCB->priorityCeiling >= pxTCB->uxBasePriority);
+	if (pxRCB->priorityCeiling > prioCurrentTask)
+	{
+		vTaskPrioritySet(xTaskHandle, (UBaseType_t)pxRCB->priorityCeiling);
+	}
+	pxRCB->xInUse = pdTRUE;
+	pxRCB->xMutexHolder = xTaskHandle;
+	prvPushHeldResource(pxTCB, xResourceIndex);
+#if (schedUSE_TRACE == 1)
+	prvTraceRecord(schedTRACE_RESOURCE_ACQUIRE, pxTCB, (uint16_t)xResourceIndex);
+#endif /* schedUSE_TRACE */
+	taskEXIT_CRITICAL();
 #elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP)
 	// Grant resource and immediately set the task's priority to ceiling priority
 	status = xSemaphoreTake(pxRCB->xMutexSem, portMAX_DELAY);
 
 	if (status == pdTRUE)
 	{
-		vTaskPrioritySet(xTaskHandle, pxRCB->priorityCeiling);
+		pxRCB->xInUse = pdTRUE;
+		pxTCB->xBlocked = pdFALSE;
+		prvPushHeldResource(pxTCB, xResourceIndex);
+		pxRCB->xMutexHolder = xTaskHandle;
+
+		/* A nested resource with a lower ceiling must not lower the priority. */
+		vTaskPrioritySet(xTaskHandle, prvHeldPriority(pxTCB));
+
+#if (schedUSE_TRACE == 1)
+		prvTrace(schedTRACE_RESOURCE_ACQUIRE, pxTCB, (uint16_t)xResourceIndex);
+#else
+		Serial.print(pxTCB->pcName);
+		Serial.print(" acquire R");
+		Serial.println(xResourceIndex + 1);
+#endif /* schedUSE_TRACE */
+	}
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_PIP)
+	BaseType_t xWaited, xNewMaxBlocking = pdFALSE;
+
+	// Take a free resource at once, or lend the priority down the chain of holders before waiting
+	taskENTER_CRITICAL();
+	configASSERT(pxRCB->xMutexHolder != xTaskHandle);
+	status = xSemaphoreTake(pxRCB->xMutexSem, 0);
+	if (status != pdTRUE)
+	{
+		pxTCB->xBlockedResource = xResourceIndex;
+		pxTCB->xBlocked = pdTRUE;
+		pxTCB->xBlockedSince = xTaskGetTickCount();
+#if (schedUSE_TRACE == 1)
+		prvTraceRecord(schedTRACE_RESOURCE_BLOCKED, pxTCB, (uint16_t)xResourceIndex);
+#endif /* schedUSE_TRACE */
+		prvPIPInheritPriority(pxRCB);
+	}
+	xWaited = pxTCB->xBlocked;
+	taskEXIT_CRITICAL();
+
+	if (pdTRUE == xWaited)
+	{
+#if (schedUSE_TRACE == 0)
+		Serial.print(pxTCB->pcName);
+		Serial.println(" blocked");
+#endif /* schedUSE_TRACE */
+		status = xSemaphoreTake(pxRCB->xMutexSem, portMAX_DELAY);
+	}
 
+	if (status == pdTRUE)
+	{
+		taskENTER_CRITICAL();
+		if (pdTRUE == pxTCB->xBlocked)
+		{
+			pxTCB->xJobBlockingTime += xTaskGetTickCount() - pxTCB->xBlockedSince;
+			if (pxTCB->xJobBlockingTime > pxTCB->xMaxBlockingTime)
+			{
+				pxTCB->xMaxBlockingTime = pxTCB->xJobBlockingTime;
+				xNewMaxBlocking = pdTRUE;
+			}
+		}
 		pxRCB->xInUse = pdTRUE;
 		pxTCB->xBlocked = pdFALSE;
-		pxTCB->xResourceAccessed = pdTRUE;
-		pxTCB->xResourceIndex = xResourceIndex;
+		prvPushHeldResource(pxTCB, xResourceIndex);
 		pxRCB->xMutexHolder = xTaskHandle;
+#if (schedUSE_TRACE == 1)
+		prvTraceRecord(schedTRACE_RESOURCE_ACQUIRE, pxTCB, (uint16_t)xResourceIndex);
+#endif /* schedUSE_TRACE */
+		taskEXIT_CRITICAL();
 
+#if (schedUSE_TRACE == 0)
 		Serial.print(pxTCB->pcName);
 		Serial.print(" acquire R");
 		Serial.println(xResourceIndex + 1);
+#endif /* schedUSE_TRACE */
+		if (pdTRUE == xNewMaxBlocking)
+		{
+			/* Report the longest blocking measured, and whether it breaks the
+			 * bound found for the declared resources. */
+			Serial.print(pxTCB->pcName);
+			Serial.print(" blocking time ");
+			Serial.println(pxTCB->xMaxBlockingTime);
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+			if (pxTCB->xMaxBlockingTime > pxTCB->xBlockingTime)
+			{
+				Serial.print(pxTCB->pcName);
+				Serial.print(" exceeds blocking bound ");
+				Serial.println(pxTCB->xBlockingTime);
+			}
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+		}
+	}
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	/* The job only started once its preemption level was above the system
+	 * ceiling, so no resource it uses can be held by another job. The resource
+	 * is free and the task never blocks. */
+	taskENTER_CRITICAL();
+	configASSERT(pdFALSE == pxRCB->xInUse);
+	pxRCB->xInUse = pdTRUE;
+	pxRCB->xMutexHolder = xTaskHandle;
+	prvPushHeldResource(pxTCB, xResourceIndex);
+	if (pxRCB->xPreemptionCeiling < xSRPSystemCeiling)
+	{
+		xSRPSystemCeiling = pxRCB->xPreemptionCeiling;
 	}
+#if (schedUSE_TRACE == 1)
+	prvTraceRecord(schedTRACE_RESOURCE_ACQUIRE, pxTCB, (uint16_t)xResourceIndex);
+#endif /* schedUSE_TRACE */
+	taskEXIT_CRITICAL();
+#if (schedUSE_TRACE == 0)
+	Serial.print(pxTCB->pcName);
+	Serial.print(" acquire R");
+	Serial.println(xResourceIndex + 1);
+#endif /* schedUSE_TRACE */
 #endif /* schedSUB_SCHEDULING_POLICY */
 }
 
 void vReleaseResource(TaskHandle_t xTaskHandle, BaseType_t xResourceIndex)
 {
-	BaseType_t xIter, status;
-	BaseType_t xCurrentTaskIndex = prvGetTCBIndexFromHandle(xTaskHandle);
 	SchedRCB_t *pxRCB = &xRCBArray[xResourceIndex];
-	SchedTCB_t *pxTCB = &xTCBArray[xCurrentTaskIndex];
+	SchedTCB_t *pxTCB = prvGetTCBFromHandle(xTaskHandle);
+#if (schedUSE_IPCP_FAST_PATH == 1)
+	UBaseType_t uxHeldPriority;
+#elif (schedSUB_SCHEDULING_POLICY != schedSUB_SCHEDULING_POLICY_SRP)
+	BaseType_t status;
+#endif /* schedUSE_IPCP_FAST_PATH */
 
 	taskENTER_CRITICAL();
 
+#if (schedUSE_TRACE == 1)
+	prvTraceRecord(schedTRACE_RESOURCE_RELEASE, pxTCB, (uint16_t)xResourceIndex);
+#elif (schedUSE_IPCP_FAST_PATH == 0)
 	Serial.print(pxTCB->pcName);
 	Serial.print(" release R");
 	Serial.println(xResourceIndex + 1);
+#endif /* schedUSE_TRACE */
 
+#if (schedUSE_IPCP_FAST_PATH == 1)
+	pxRCB->xInUse = pdFALSE;
+	pxRCB->xMutexHolder = NULL;
+	prvPopHeldResource(pxTCB, xResourceIndex);
+
+	/* Only a lower priority can let another task run. */
+	uxHeldPriority = prvHeldPriority(pxTCB);
+	if (uxHeldPriority != uxTaskPriorityGet(xTaskHandle))
+	{
+		vTaskPrioritySet(xTaskHandle, uxHeldPriority);
+	}
+#elif (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	pxRCB->xInUse = pdFALSE;
+	pxRCB->xMutexHolder = NULL;
+	prvPopHeldResource(pxTCB, xResourceIndex);
+	prvSRPUpdateSystemCeiling();
+	/* Jobs held back by the ceiling may start now. */
+	prvUpdateEDFPriorities(pdTRUE);
+#else
 	status = xSemaphoreGive(pxRCB->xMutexSem);
 
 	if (status == pdTRUE)
 	{
 		pxRCB->xInUse = pdFALSE;
+		pxRCB->xMutexHolder = NULL;
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP)
+		prvOPCPUnlock(pxRCB);
+#endif /* schedSUB_SCHEDULING_POLICY */
 		pxTCB->xBlocked = pdFALSE;
-		pxTCB->xResourceAccessed = pdFALSE;
+		prvPopHeldResource(pxTCB, xResourceIndex);
+
+		/* Resources that are still held keep the priority they need. */
+		vTaskPrioritySet(xTaskHandle, prvHeldPriority(pxTCB));
+	}
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+#if (schedUSE_EVENT_DRIVEN_SCHEDULER == 1 && schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
+	/* Deadline order changes that happened while the resource was held are applied now. */
+	if (pdTRUE == xEDFOrderChanged)
+	{
+		prvWakeScheduler();
+	}
+#endif /* schedUSE_EVENT_DRIVEN_SCHEDULER && schedSCHEDULING_POLICY */
+
+	taskEXIT_CRITICAL();
+}
+
+/* Called by the kernel from traceTASK_SWITCHED_IN with the task tag of the
+ * task that is about to run. */
+void vSchedulerTaskSwitchedIn(void *pvTaskTag)
+{
+	SchedTCB_t *pxTCB = (SchedTCB_t *)pvTaskTag;
+
+	pxCurrentSchedTCB = pxTCB;
+	if (NULL != pxTCB)
+	{
+		pxTCB->xSwitchInTime = schedEXEC_TIME_NOW();
+#if (schedUSE_BUDGET_TIMER == 1)
+		prvBudgetTimerArm(pxTCB);
+#endif /* schedUSE_BUDGET_TIMER */
+#if (schedUSE_TRACE == 1)
+		prvTraceRecord(schedTRACE_SWITCH_IN, pxTCB, 0);
+#endif /* schedUSE_TRACE */
+	}
+}
+
+/* Called by the kernel from traceTASK_SWITCHED_OUT with the task tag of the
+ * task that stops running. Adds the time it ran to the current job. */
+void vSchedulerTaskSwitchedOut(void *pvTaskTag)
+{
+	SchedTCB_t *pxTCB = (SchedTCB_t *)pvTaskTag;
+
+	if (NULL != pxTCB)
+	{
+#if (schedUSE_BUDGET_TIMER == 1)
+		prvBudgetTimerStop();
+#endif /* schedUSE_BUDGET_TIMER */
+		pxTCB->xExecTime += (SchedExecTime_t)(schedEXEC_TIME_NOW() - pxTCB->xSwitchInTime);
+#if (schedUSE_TRACE == 1)
+		prvTraceRecord(schedTRACE_SWITCH_OUT, pxTCB, 0);
+#endif /* schedUSE_TRACE */
+	}
+}
 
-		vTaskPrioritySet(xTaskHandle, pxTCB->uxBasePriority);
+#if (schedUSE_TRACE == 1)
+/* Writes a record at the head of the trace buffer, which must have room for
+ * it. */
+static void prvTracePut(uint32_t ulTimestamp, uint8_t ucEvent, uint8_t ucTask, uint16_t usArg)
+{
+	uint8_t ucHead = ucTraceHead;
+	volatile SchedTraceRecord_t *pxRecord = &xTraceBuffer[ucHead];
+
+	pxRecord->ulTimestamp = ulTimestamp;
+	pxRecord->ucEvent = ucEvent;
+	pxRecord->ucTask = ucTask;
+	pxRecord->usArg = usArg;
+	/* Publish the record only after it is complete. */
+	ucTraceHead = (uint8_t)((ucHead + 1) & (schedTRACE_BUFFER_LENGTH - 1));
+}
+
+/* Appends a record to the trace buffer, or counts it as dropped if the buffer
+ * is full. Once there is room again, a schedTRACE_DROPPED record goes in first,
+ * so the gap shows up in the stream where the records were lost. Must be
+ * called with interrupts disabled: from the tick hook, the context switch
+ * hooks or inside a critical section. */
+static void prvTraceRecord(uint8_t ucEvent, SchedTCB_t *pxTCB, uint16_t usArg)
+{
+	uint8_t ucFree = (uint8_t)((ucTraceTail - ucTraceHead - 1) & (schedTRACE_BUFFER_LENGTH - 1));
+	uint32_t ulNow = (uint32_t)schedEXEC_TIME_NOW();
+
+	if (0 != usTraceDropped && ucFree >= 2)
+	{
+		prvTracePut(ulTraceDropTime, schedTRACE_DROPPED, schedTRACE_NO_TASK, usTraceDropped);
+		usTraceDropped = 0;
+	}
+	else if (0 != usTraceDropped || 0 == ucFree)
+	{
+		if (0 == usTraceDropped)
+		{
+			ulTraceDropTime = ulNow;
+		}
+		if (0xFFFF != usTraceDropped)
+		{
+			usTraceDropped++;
+		}
+		return;
 	}
 
+	prvTracePut(ulNow, ucEvent, (NULL == pxTCB) ? schedTRACE_NO_TASK : (uint8_t)(pxTCB - xTCBArray), usArg);
+}
+
+/* Records an event from task context and wakes the trace task. */
+static void prvTrace(uint8_t ucEvent, SchedTCB_t *pxTCB, uint16_t usArg)
+{
+	taskENTER_CRITICAL();
+	prvTraceRecord(ucEvent, pxTCB, usArg);
 	taskEXIT_CRITICAL();
+
+	if (NULL != xTraceHandle)
+	{
+		xTaskNotifyGive(xTraceHandle);
+	}
+}
+
+/* Wakes the trace task from the tick hook if records are waiting. Records
+ * added by the context switch hooks or inside critical sections are sent at
+ * the latest one tick later. Without the scheduler task there is no tick hook,
+ * and they wait for the next record from prvTrace. The trace task runs at the idle priority, so no
+ * context switch is requested. */
+static void prvTraceWakeFromISR(void)
+{
+	if (NULL != xTraceHandle && ucTraceHead != ucTraceTail)
+	{
+		vTaskNotifyGiveFromISR(xTraceHandle, NULL);
+	}
+}
+
+/* Sends one record as a frame, see schedtrace.h. */
+static void prvTraceSend(uint32_t ulTimestamp, uint8_t ucEvent, uint8_t ucTask, uint16_t usArg)
+{
+	uint8_t ucFrame[schedTRACE_FRAME_SIZE];
+
+	ucFrame[0] = schedTRACE_SYNC_0;
+	ucFrame[1] = schedTRACE_SYNC_1;
+	ucFrame[2] = (uint8_t)ulTimestamp;
+	ucFrame[3] = (uint8_t)(ulTimestamp >> 8);
+	ucFrame[4] = (uint8_t)(ulTimestamp >> 16);
+	ucFrame[5] = (uint8_t)(ulTimestamp >> 24);
+	ucFrame[6] = ucEvent;
+	ucFrame[7] = ucTask;
+	ucFrame[8] = (uint8_t)usArg;
+	ucFrame[9] = (uint8_t)(usArg >> 8);
+	Serial.write(ucFrame, sizeof(ucFrame));
+}
+
+/* Sends name, period and relative deadline of the task in slot ucTask. The
+ * name is split into records of four characters, the last one holds less than
+ * four. */
+static void prvTraceDescribeTask(uint8_t ucTask)
+{
+	SchedTCB_t *pxTCB = &xTCBArray[ucTask];
+	uint32_t ulNow = (uint32_t)schedEXEC_TIME_NOW();
+	uint16_t usOffset;
+
+	for (usOffset = 0; usOffset < configMAX_TASK_NAME_LEN; usOffset += 4)
+	{
+		uint32_t ulChars = 0;
+		uint8_t ucCount;
+
+		for (ucCount = 0; ucCount < 4 && usOffset + ucCount < configMAX_TASK_NAME_LEN && '\0' != pxTCB->pcName[usOffset + ucCount]; ucCount++)
+		{
+			ulChars |= (uint32_t)(uint8_t)pxTCB->pcName[usOffset + ucCount] << (8 * ucCount);
+		}
+		prvTraceSend(ulChars, schedTRACE_TASK_NAME, ucTask, usOffset);
+		if (ucCount < 4)
+		{
+			break;
+		}
+	}
+	prvTraceSend(ulNow, schedTRACE_TASK_PERIOD, ucTask, (uint16_t)pxTCB->xPeriod);
+	prvTraceSend(ulNow, schedTRACE_TASK_DEADLINE, ucTask, (uint16_t)pxTCB->xRelativeDeadline);
+}
+
+/* Sends the trace records over Serial. Runs at the idle priority and sleeps
+ * while the buffer is empty. A frame is only written if it fits into the
+ * transmit buffer, so tracing never makes a periodic task wait for the serial
+ * port. */
+static void prvTraceTask(void *pvParameters)
+{
+	(void)pvParameters;
+
+#if (schedUSE_HIGH_RESOLUTION_EXEC_TIME == 1)
+	prvTraceSend((uint32_t)schedEXEC_TIME_NOW(), schedTRACE_START, schedTRACE_NO_TASK, 1);
+#else
+	prvTraceSend((uint32_t)schedEXEC_TIME_NOW(), schedTRACE_START, schedTRACE_NO_TASK, (uint16_t)(portTICK_PERIOD_MS * 1000UL));
+#endif /* schedUSE_HIGH_RESOLUTION_EXEC_TIME */
+	prvTraceSend((uint32_t)schedEXEC_TIME_NOW(), schedTRACE_TICK_PERIOD, schedTRACE_NO_TASK, (uint16_t)(portTICK_PERIOD_MS * 1000UL));
+
+	for (;;)
+	{
+		uint8_t ucTail = ucTraceTail;
+		uint32_t ulTimestamp;
+		uint8_t ucEvent, ucTask;
+		uint16_t usArg;
+
+		if (ucTail == ucTraceHead)
+		{
+			ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+			continue;
+		}
+		if (Serial.availableForWrite() < schedTRACE_FRAME_SIZE)
+		{
+			/* The serial port drains on its own, wait for it. */
+			vTaskDelay(1);
+			continue;
+		}
+
+		/* The producers do not touch the entry at ucTail until it is released. */
+		ulTimestamp = xTraceBuffer[ucTail].ulTimestamp;
+		ucEvent = xTraceBuffer[ucTail].ucEvent;
+		ucTask = xTraceBuffer[ucTail].ucTask;
+		usArg = xTraceBuffer[ucTail].usArg;
+		ucTraceTail = (uint8_t)((ucTail + 1) & (schedTRACE_BUFFER_LENGTH - 1));
+
+		if (schedTRACE_NO_TASK != ucTask && 0 == (ulTraceDescribed & (1UL << ucTask)))
+		{
+			taskENTER_CRITICAL();
+			ulTraceDescribed |= 1UL << ucTask;
+			taskEXIT_CRITICAL();
+			prvTraceDescribeTask(ucTask);
+		}
+		prvTraceSend(ulTimestamp, ucEvent, ucTask, usArg);
+	}
+}
+
+/* Creates the trace task. */
+static void prvCreateTraceTask(void)
+{
+#if (schedUSE_STATIC_ALLOCATION == 1)
+	xTraceHandle = xTaskCreateStatic(prvTraceTask, "Trace", schedTRACE_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY, uxTraceStack, &xTraceTaskBuffer);
+#else
+	xTaskCreate(prvTraceTask, "Trace", schedTRACE_TASK_STACK_SIZE, NULL, tskIDLE_PRIORITY, &xTraceHandle);
+#endif /* schedUSE_STATIC_ALLOCATION */
+}
+#endif /* schedUSE_TRACE */
+
+#if (schedUSE_HIGH_RESOLUTION_EXEC_TIME == 1)
+#if defined(__AVR__)
+/* Timer1 runs free at schedRUN_TIME_COUNTER_HZ. Its overflow interrupt counts
+ * the upper 16 bits of the run time counter. */
+static volatile uint16_t usRunTimeCounterHigh = 0;
+
+ISR(TIMER1_OVF_vect)
+{
+	usRunTimeCounterHigh++;
+}
+
+#if (schedUSE_BUDGET_TIMER == 1)
+/* Budgets shorter than this many counter steps are rounded up, so that the
+ * compare match is not passed before it is written. */
+#define schedBUDGET_TIMER_MIN_COUNTS 2UL
+
+/* Run time counter value at which the budget timer expires. */
+static volatile uint32_t ulBudgetTimerExpiry = 0;
+
+/* Compare match A of Timer1 comes every 65536 counter steps, so a budget can
+ * take several matches to run out. */
+ISR(TIMER1_COMPA_vect)
+{
+	if ((int32_t)(ulSchedulerGetRunTimeCounter() - ulBudgetTimerExpiry) >= 0)
+	{
+		TIMSK1 &= (uint8_t)~_BV(OCIE1A);
+		prvBudgetTimerExpired();
+	}
+}
+
+/* Makes the budget timer expire ulCounts counter steps from now. Must be
+ * called with interrupts disabled. */
+static void prvBudgetTimerStart(uint32_t ulCounts)
+{
+	if (ulCounts < schedBUDGET_TIMER_MIN_COUNTS)
+	{
+		ulCounts = schedBUDGET_TIMER_MIN_COUNTS;
+	}
+	ulBudgetTimerExpiry = ulSchedulerGetRunTimeCounter() + ulCounts;
+	OCR1A = (uint16_t)ulBudgetTimerExpiry;
+	TIFR1 = _BV(OCF1A);
+	TIMSK1 |= _BV(OCIE1A);
+}
+
+static void prvBudgetTimerStop(void)
+{
+	TIMSK1 &= (uint8_t)~_BV(OCIE1A);
+}
+#endif /* schedUSE_BUDGET_TIMER */
+
+/* Called by the kernel through portCONFIGURE_TIMER_FOR_RUN_TIME_STATS when the scheduler starts. */
+void vSchedulerConfigureRunTimeCounter(void)
+{
+	TCCR1A = 0;
+	TCCR1B = _BV(CS11) | _BV(CS10); /* Normal mode, clk/64. */
+	TCNT1 = 0;
+	TIFR1 = _BV(TOV1);
+	TIMSK1 = _BV(TOIE1);
+}
+
+/* Returns the 32 bit run time counter. Safe to call from ISRs and with interrupts disabled. */
+uint32_t ulSchedulerGetRunTimeCounter(void)
+{
+	uint8_t ucStatus = SREG;
+	uint16_t usHigh, usLow;
+
+	cli();
+	usLow = TCNT1;
+	usHigh = usRunTimeCounterHigh;
+	/* An overflow that is not serviced yet belongs to this reading. */
+	if ((TIFR1 & _BV(TOV1)) && usLow < 0x8000)
+	{
+		usHigh++;
+	}
+	SREG = ucStatus;
+
+	return ((uint32_t)usHigh << 16) | usLow;
+}
+#else
+#if (schedUSE_BUDGET_TIMER == 1)
+/* Signal of the budget timer. The POSIX port blocks all signals in critical
+ * sections, so the handler runs like an interrupt, as the tick handler of the
+ * port does. */
+#define schedBUDGET_TIMER_SIGNAL SIGRTMIN
+
+static timer_t xBudgetTimer;
+/* pdFALSE until the kernel has started, and in host tests on the mock kernel,
+ * which leave the budget to the tick hook. */
+static BaseType_t xBudgetTimerCreated = pdFALSE;
+
+static void prvBudgetTimerSignalHandler(int iSignal)
+{
+	(void)iSignal;
+	prvBudgetTimerExpired();
+}
+
+/* Makes the budget timer expire ulCounts counter steps from now. */
+static void prvBudgetTimerStart(uint32_t ulCounts)
+{
+	struct itimerspec xValue = {};
+	uint64_t ullNanoseconds = (uint64_t)ulCounts * (1000000000UL / schedRUN_TIME_COUNTER_HZ);
+
+	if (pdTRUE == xBudgetTimerCreated)
+	{
+		xValue.it_value.tv_sec = (time_t)(ullNanoseconds / 1000000000UL);
+		xValue.it_value.tv_nsec = (long)(ullNanoseconds % 1000000000UL);
+		timer_settime(xBudgetTimer, 0, &xValue, NULL);
+	}
+}
+
+static void prvBudgetTimerStop(void)
+{
+	struct itimerspec xValue = {};
+
+	if (pdTRUE == xBudgetTimerCreated)
+	{
+		timer_settime(xBudgetTimer, 0, &xValue, NULL);
+	}
 }
+#endif /* schedUSE_BUDGET_TIMER */
+
+/* Host builds read the monotonic clock, which needs no setup. The budget timer
+ * is created here, when the kernel starts. */
+void vSchedulerConfigureRunTimeCounter(void)
+{
+#if (schedUSE_BUDGET_TIMER == 1)
+	struct sigaction xAction = {};
+	struct sigevent xEvent = {};
+
+	xAction.sa_handler = prvBudgetTimerSignalHandler;
+	sigfillset(&xAction.sa_mask);
+	xEvent.sigev_notify = SIGEV_SIGNAL;
+	xEvent.sigev_signo = schedBUDGET_TIMER_SIGNAL;
+	if (0 == sigaction(schedBUDGET_TIMER_SIGNAL, &xAction, NULL) && 0 == timer_create(CLOCK_MONOTONIC, &xEvent, &xBudgetTimer))
+	{
+		xBudgetTimerCreated = pdTRUE;
+	}
+#endif /* schedUSE_BUDGET_TIMER */
+}
+
+uint32_t ulSchedulerGetRunTimeCounter(void)
+{
+	struct timespec xNow;
+
+	clock_gettime(CLOCK_MONOTONIC, &xNow);
+	return (uint32_t)((uint64_t)xNow.tv_sec * schedRUN_TIME_COUNTER_HZ + (uint64_t)xNow.tv_nsec / (1000000000UL / schedRUN_TIME_COUNTER_HZ));
+}
+#endif /* __AVR__ */
+#endif /* schedUSE_HIGH_RESOLUTION_EXEC_TIME */
 
 /* This function must be called before any other function call from this module. */
 void vSchedulerInit(void)
@@ -986,28 +3497,51 @@ void vSchedulerInit(void)
 #if (schedUSE_TCB_ARRAY == 1)
 	prvInitTCBArray();
 #endif /* schedUSE_TCB_ARRAY */
+	prvInitRCBArray();
 }
 
 /* Starts scheduling tasks. All periodic tasks (including polling server) must
  * have been created with API function before calling this function. */
 void vSchedulerStart(void)
 {
-#if ((schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_RMS) || (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_DM))
-	prvSetFixedPriorities();
+#if (schedUSE_FIXED_PRIORITIES)
+	prvPrintFixedPriorities(prvSetFixedPriorities());
 #if ((schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_OPCP) || (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP))
 	prvSetPriorityCeilings();
 #endif /* schedSUB_SCHEDULING_POLICY */
 #elif (schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF)
 	prvSetEDFInitialPriorities();
+#if (schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_SRP)
+	prvSetPreemptionCeilings();
+#endif /* schedSUB_SCHEDULING_POLICY */
 #endif /* schedSCHEDULING_POLICY */
 
+#if (schedUSE_SCHEDULABILITY_TEST == 1)
+	BaseType_t xSchedulable = prvCheckSchedulability(NULL);
+
+	prvPrintSchedulability(NULL, xSchedulable);
+	if (pdFALSE == xSchedulable)
+	{
+		Serial.println("task set is not schedulable");
+		Serial.flush();
+#if (schedREJECT_UNSCHEDULABLE == 1)
+		/* Refuse to start, no task has been created yet. */
+		return;
+#endif /* schedREJECT_UNSCHEDULABLE */
+	}
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
 #if (schedUSE_SCHEDULER_TASK == 1)
 	prvCreateSchedulerTask();
 #endif /* schedUSE_SCHEDULER_TASK */
+#if (schedUSE_TRACE == 1)
+	prvCreateTraceTask();
+#endif /* schedUSE_TRACE */
 
 	xSystemStartTime = xTaskGetTickCount();
 
 	prvCreateAllTasks();
+	xSchedulerRunning = pdTRUE;
 
 	vTaskStartScheduler();
 }
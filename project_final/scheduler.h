@@ -28,16 +28,36 @@ extern "C" {
 #define schedSCHEDULING_POLICY_RMS 	1 	/* Rate-monotonic scheduling */
 #define schedSCHEDULING_POLICY_DM 	2	/* Deadline-monotonic scheduling */
 #define schedSCHEDULING_POLICY_EDF	3	/* Earliest Deadline First scheduling */
+#define schedSCHEDULING_POLICY_OPA	4	/* Fixed priorities by Audsley's optimal priority assignment */
 
-/* The sub scheduling policy can be chosen from one of these. */
+/* The sub scheduling policy can be chosen from one of these. OPCP and IPCP
+ * take the ceilings from task priorities. Under EDF with priority bands all
+ * parked jobs share one priority, so they cannot be used there. Without bands
+ * the ceilings follow the EDF ranks of the jobs, which change with every
+ * release. SRP (Baker's stack resource policy) is for EDF with
+ * schedUSE_EDF_PRIORITY_BANDS: preemption levels follow the relative
+ * deadlines, and a job only starts once its level is above the ceilings of all
+ * resources in use. A job is then blocked at most once, before it starts, and
+ * never waits for a resource, so every task must declare the resources it uses
+ * in its resource list. PIP (priority inheritance) needs fixed priorities but
+ * no ceilings: a task that waits for a resource lends its priority to the
+ * holder, and down the chain if the holder waits for a resource too. Tasks may
+ * use resources they do not declare; the schedulability test bounds blocking
+ * by the declared ones, and the blocking each task sees is measured. */
 #define schedSUB_SCHEDULING_POLICY_OPCP 1
 #define schedSUB_SCHEDULING_POLICY_IPCP 2
+#define schedSUB_SCHEDULING_POLICY_SRP 3
+#define schedSUB_SCHEDULING_POLICY_PIP 4
 
 /* Configure scheduling policy by setting this define to the appropriate one. */
 #define schedSCHEDULING_POLICY schedSCHEDULING_POLICY_EDF
 
-/* Configure sub scheduling policy. */
-#define schedSUB_SCHEDULING_POLICY schedSUB_SCHEDULING_POLICY_IPCP
+/* Configure sub scheduling policy. EDF with priority bands needs SRP, see above. */
+#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+	#define schedSUB_SCHEDULING_POLICY schedSUB_SCHEDULING_POLICY_SRP
+#else
+	#define schedSUB_SCHEDULING_POLICY schedSUB_SCHEDULING_POLICY_IPCP
+#endif /* schedSCHEDULING_POLICY */
 
 /* Maximum number of periodic tasks that can be created. (Scheduler task is
  * not included) */
@@ -46,16 +66,109 @@ extern "C" {
 /* number of shared resources. */
 #define schedMAX_NUMBER_OF_SHARED_RESOURCES 2
 
+/* Maximum number of shared resources a single task uses, and holds at once.
+ * Tasks keep a list of the resources they use rather than an entry for every
+ * resource, so many resources cost little memory as long as each task only
+ * uses a few of them. */
+#define schedMAX_RESOURCES_PER_TASK 2
+
 /* Set this define to 1 to enable Timing-Error-Detection for detecting tasks
  * that have missed their deadlines. Tasks that have missed their deadlines
- * will be deleted, recreated and restarted during next period. */
+ * will be handled according to their deadline miss policy. */
 #define schedUSE_TIMING_ERROR_DETECTION_DEADLINE 1
 
+/* Reaction of a periodic task to a missed deadline, chosen per task in
+ * vSchedulerPeriodicTaskCreate. */
+#define schedDEADLINE_MISS_ABORT		1	/* Delete the job and restart the task at its next release. */
+#define schedDEADLINE_MISS_SKIP_NEXT	2	/* Finish the job late and skip the next release. */
+#define schedDEADLINE_MISS_CONTINUE		3	/* Finish the job late and catch up the passed releases. */
+#define schedDEADLINE_MISS_DEGRADE		4	/* Finish the job late, then run the degraded job function
+											 * until a job meets its deadline again. */
+
 /* Set this define to 1 to enable Timing-Error-Detection for detecting tasks
  * that have exceeded their worst-case execution time. Tasks that have exceeded
  * their worst-case execution time will be preempted until next period. */
 #define schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME 1
 
+/* Set this define to 1 to create periodic tasks, the scheduler task and the
+ * resource semaphores without the heap, using xTaskCreateStatic and
+ * xSemaphoreCreateBinaryStatic. Needs configSUPPORT_STATIC_ALLOCATION. */
+#define schedUSE_STATIC_ALLOCATION 1
+
+#if( schedUSE_STATIC_ALLOCATION == 1 )
+	/* Set this define to 1 to reserve task memory for the periodic tasks created
+	 * with vSchedulerPeriodicTaskCreate. Set it to 0 if all periodic tasks are
+	 * created with vSchedulerPeriodicTaskCreateStatic. Not used with
+	 * schedUSE_SHARED_STACK. */
+	#define schedUSE_STATIC_TASK_POOL 1
+
+	#if( schedUSE_STATIC_TASK_POOL == 1 )
+		/* Number of periodic tasks that can use reserved memory at the same time,
+		 * at most schedMAX_NUMBER_OF_PERIODIC_TASKS. Every entry is reserved
+		 * whether a task uses it or not, so keep it at the number of tasks the
+		 * application creates. */
+		#define schedSTATIC_TASK_POOL_SIZE 4
+		/* Stack size in words of each reserved periodic task stack. */
+		#define schedSTATIC_TASK_STACK_SIZE configMINIMAL_STACK_SIZE
+	#endif /* schedUSE_STATIC_TASK_POOL */
+#endif /* schedUSE_STATIC_ALLOCATION */
+
+/* Set this define to 1 to run the jobs of all periodic tasks with the same
+ * relative deadline on one worker task per preemption level. Under SRP such
+ * jobs never run at the same time, so they take turns on the stack of the
+ * worker and stack memory grows with the number of distinct deadlines instead
+ * of the number of tasks. The tasks of a level share the handle of its worker,
+ * which refers to the task whose job is running on it. Needs
+ * schedSUB_SCHEDULING_POLICY_SRP. */
+#define schedUSE_SHARED_STACK 0
+
+#if( schedUSE_SHARED_STACK == 1 )
+	/* Maximum number of distinct relative deadlines, one worker task each. */
+	#define schedMAX_NUMBER_OF_PREEMPTION_LEVELS 3
+	/* Stack size in words of each worker task. It must hold the deepest job of
+	 * its level. */
+	#define schedSHARED_STACK_SIZE configMINIMAL_STACK_SIZE
+#endif /* schedUSE_SHARED_STACK */
+
+/* Set this define to 1 to measure execution times and budgets in microseconds
+ * with a free running hardware counter (Timer1 on AVR, the monotonic clock on
+ * host builds) instead of whole software ticks. The counter is also used for
+ * the kernel run time stats, see configGENERATE_RUN_TIME_STATS. */
+#define schedUSE_HIGH_RESOLUTION_EXEC_TIME 1
+
+#if( schedUSE_HIGH_RESOLUTION_EXEC_TIME == 1 )
+	/* Frequency of the run time counter. Timer1 counts at F_CPU / 64. */
+	#if defined( __AVR__ )
+		#define schedRUN_TIME_COUNTER_HZ ( F_CPU / 64UL )
+	#else
+		#define schedRUN_TIME_COUNTER_HZ 1000000UL
+	#endif
+	/* Length of one counter step in microseconds. */
+	#define schedRUN_TIME_COUNTER_PERIOD_US ( 1000000UL / schedRUN_TIME_COUNTER_HZ )
+
+	/* Set this define to 1 to stop a job as soon as its budget runs out. A one
+	 * shot timer (Timer1 compare match A on AVR, a POSIX timer on host builds)
+	 * is armed for the rest of the budget whenever the job is switched in, and
+	 * its interrupt hands the job over to the scheduler task. Otherwise the
+	 * budget is only checked in the tick hook. Needs
+	 * schedUSE_TIMING_ERROR_DETECTION_EXECUTION_TIME. */
+	#define schedUSE_BUDGET_TIMER 1
+#endif /* schedUSE_HIGH_RESOLUTION_EXEC_TIME */
+
+/* Set this define to 1 to check in vSchedulerStart, before any task is
+ * created, that no deadline can be missed. Under RMS, DM and OPA an exact response
+ * time analysis is used, with blocking terms taken from the critical section
+ * lengths in the resource lists of the tasks. Under EDF the processor demand is checked with
+ * Quick Processor-demand Analysis, which also covers deadlines shorter than
+ * periods. The worst-case response time of each task is printed. */
+#define schedUSE_SCHEDULABILITY_TEST 1
+
+#if( schedUSE_SCHEDULABILITY_TEST == 1 )
+	/* Set this define to 1 to make vSchedulerStart return without starting the
+	 * tasks if the task set is not schedulable. If set to 0 it is only reported. */
+	#define schedREJECT_UNSCHEDULABLE 1
+#endif /* schedUSE_SCHEDULABILITY_TEST */
+
 /* Set this define to 1 to enable the scheduler task. This define must be set to 1
 * when using following features:
 * EDF scheduling policy, Timing-Error-Detection of execution time,
@@ -66,41 +179,127 @@ extern "C" {
 #if( schedUSE_SCHEDULER_TASK == 1 )
 	/* Priority of the scheduler task. */
 	#define schedSCHEDULER_PRIORITY ( configMAX_PRIORITIES - 1 )
-	/* Stack size of the scheduler task. */
-	#define schedSCHEDULER_TASK_STACK_SIZE 200 
+	/* Stack size of the scheduler task. Host builds need at least a thread stack. */
+	#if defined( __AVR__ )
+		#define schedSCHEDULER_TASK_STACK_SIZE 200
+	#else
+		#define schedSCHEDULER_TASK_STACK_SIZE configMINIMAL_STACK_SIZE
+	#endif
 	/* The period of the scheduler task in software ticks. */
 	#define schedSCHEDULER_TASK_PERIOD pdMS_TO_TICKS( 50 )
+	/* Set this define to 1 to wake the scheduler task only on scheduling events
+	 * (job release and completion, execution time exceeded, resource release,
+	 * deadline and unblock times) instead of every schedSCHEDULER_TASK_PERIOD. */
+	#define schedUSE_EVENT_DRIVEN_SCHEDULER 1
 #endif /* schedUSE_SCHEDULER_TASK */
 
+/* Set this define to 1 to record scheduling events (releases, context switches,
+ * resource accesses, timing errors) into a binary ring buffer instead of
+ * printing them, see schedtrace.h. Recording takes a few cycles and is safe in
+ * the tick hook. A task at the idle priority sends the records over Serial;
+ * events that do not fit into the buffer are dropped and counted. The frames
+ * share the serial port with the text the tasks print, and the trace task and
+ * buffer take RAM of their own, so tracing is off by default. */
+#define schedUSE_TRACE 0
+
+#if( schedUSE_TRACE == 1 )
+	/* Number of records in the ring buffer, a power of two up to 128. */
+	#define schedTRACE_BUFFER_LENGTH 32
+	/* Stack size of the trace task. */
+	#define schedTRACE_TASK_STACK_SIZE configMINIMAL_STACK_SIZE
+#endif /* schedUSE_TRACE */
+
+#if( schedSCHEDULING_POLICY == schedSCHEDULING_POLICY_EDF )
+	/* Set this define to 1 to dispatch EDF jobs through priority bands instead of
+	 * giving every task its own priority level. The job with the earliest deadline
+	 * runs alone in the running band, all other ready jobs are parked below it, and
+	 * tasks waiting for their next release wait in the release band so they can
+	 * register the release right away. EDF order is kept for any number of tasks. */
+	#define schedUSE_EDF_PRIORITY_BANDS 1
+
+	#if( schedUSE_EDF_PRIORITY_BANDS == 1 )
+		#define schedEDF_RELEASE_PRIORITY	( schedSCHEDULER_PRIORITY - 1 )
+		#define schedEDF_RUNNING_PRIORITY	( schedSCHEDULER_PRIORITY - 2 )
+		#define schedEDF_PARKED_PRIORITY	( tskIDLE_PRIORITY + 1 )
+	#endif /* schedUSE_EDF_PRIORITY_BANDS */
+#endif /* schedSCHEDULING_POLICY */
+
+#if( schedSUB_SCHEDULING_POLICY == schedSUB_SCHEDULING_POLICY_IPCP )
+	/* Set this define to 1 to take and give resources under IPCP without a
+	 * semaphore. On one core a task raised to the ceiling already keeps out
+	 * every other task using the resource, so a request only raises the
+	 * priority and a release only lowers it, each when the priority changes.
+	 * Nothing is printed over Serial. A task must not wait or delay while it
+	 * holds a resource, and must list every resource it uses. */
+	#define schedUSE_IPCP_FAST_PATH 0
+#endif /* schedSUB_SCHEDULING_POLICY */
+
+/* Use of one shared resource by a periodic task. */
+typedef struct xSchedResourceUse
+{
+	BaseType_t xResourceIndex;	/* Resource as passed to vRequestResource. */
+	TickType_t xHoldTick;		/* Longest time the task holds the resource, in software ticks. */
+} SchedResourceUse_t;
+
 /* This function must be called before any other function call from scheduler.h. */
 void vSchedulerInit( void );
 
-/* Creates a periodic task.
+/* Creates a periodic task. Tasks created before vSchedulerStart are started by
+ * it. A task created while the scheduler is running is admitted only if the
+ * task set stays schedulable (with schedUSE_SCHEDULABILITY_TEST) and a slot is
+ * free, otherwise *pxCreatedTask is set to NULL. Its phase counts from the call.
  *
  * pvTaskCode: The task function.
  * pcName: Name of the task.
- * usStackDepth: Stack size of the task in words, not bytes.
+ * usStackDepth: Stack size of the task in words, not bytes. With schedUSE_SHARED_STACK
+ *   the job runs on the stack of its level, see schedSHARED_STACK_SIZE.
  * pvParameters: Parameters to the task function.
  * uxPriority: Priority of the task. (Only used when scheduling policy is set to manual)
- * pxCreatedTask: Pointer to the task handle.
+ * pxCreatedTask: Pointer to the task handle. With schedUSE_SHARED_STACK the handle of the worker
+ *   task of its level.
  * xPhaseTick: Phase given in software ticks. Counted from when vSchedulerStart is called.
  * xPeriodTick: Period given in software ticks.
  * xMaxExecTimeTick: Worst-case execution time given in software ticks.
  * xDeadlineTick: Relative deadline given in software ticks.
+ * pxResourceUse: The shared resources the task uses, NULL if it uses none.
+ * uxResourceUseCount: Number of entries in pxResourceUse, at most schedMAX_RESOURCES_PER_TASK.
+ * xMissPolicy: Reaction to a missed deadline, one of schedDEADLINE_MISS_*.
+ * pvDegradedTaskCode: Job function used with schedDEADLINE_MISS_DEGRADE, NULL otherwise.
  * */
 void vSchedulerPeriodicTaskCreate( TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
-		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, TickType_t xRTickArray[schedMAX_NUMBER_OF_SHARED_RESOURCES] );
+		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, const SchedResourceUse_t *pxResourceUse,
+		UBaseType_t uxResourceUseCount, BaseType_t xMissPolicy, TaskFunction_t pvDegradedTaskCode );
+
+#if( schedUSE_STATIC_ALLOCATION == 1 && schedUSE_SHARED_STACK == 0 )
+/* Creates a periodic task like vSchedulerPeriodicTaskCreate, using the given
+ * memory instead of the reserved pool.
+ *
+ * puxStackBuffer: Stack of the task, at least usStackDepth words.
+ * pxTaskBuffer: Memory for the kernel TCB of the task.
+ * */
+void vSchedulerPeriodicTaskCreateStatic( TaskFunction_t pvTaskCode, const char *pcName, UBaseType_t uxStackDepth, void *pvParameters, UBaseType_t uxPriority,
+		TaskHandle_t *pxCreatedTask, TickType_t xPhaseTick, TickType_t xPeriodTick, TickType_t xMaxExecTimeTick, TickType_t xDeadlineTick, const SchedResourceUse_t *pxResourceUse,
+		UBaseType_t uxResourceUseCount, BaseType_t xMissPolicy, TaskFunction_t pvDegradedTaskCode, StackType_t *puxStackBuffer, StaticTask_t *pxTaskBuffer );
+#endif /* schedUSE_STATIC_ALLOCATION && schedUSE_SHARED_STACK */
 
-/* Deletes a periodic task associated with the given task handle. */
+/* Deletes a periodic task associated with the given task handle, or the calling
+ * task if xTaskHandle is NULL. Its slot can be reused by the next created task.
+ * With schedUSE_SHARED_STACK a job is running on the worker of the handle, and
+ * the task of that job is deleted. */
 void vSchedulerPeriodicTaskDelete( TaskHandle_t xTaskHandle );
 
-/* Request a resource */
+/* Request a resource. Requests can be nested, a task may hold up to
+ * schedMAX_RESOURCES_PER_TASK resources at once. Under OPCP the request is
+ * checked against the system ceiling, the highest ceiling of the resources in
+ * use, without visiting every resource. */
 void vRequestResource( TaskHandle_t xTaskHandle, BaseType_t xResourceIndex );
 
-/* Release a resource */
+/* Release a resource. The task keeps the priority that the resources it
+ * still holds require. */
 void vReleaseResource( TaskHandle_t xTaskHandle, BaseType_t xResourceIndex );
 
-/* Starts scheduling tasks. */
+/* Starts scheduling tasks. Returns only if the task set was rejected by the
+ * schedulability test. */
 void vSchedulerStart( void );
 
 #ifdef __cplusplus